@@ -5,6 +5,16 @@
 #include <sstream>
 #include <cstring>
 #include <concepts>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+
+#include "thread_pool.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define LINALG_X86_KERNELS
+#endif
 
 template<typename T>
 concept HasModule = requires(T a) {
@@ -13,6 +23,409 @@ concept HasModule = requires(T a) {
 
 namespace linalg {
 
+// Element types with exact arithmetic, such as integers or rationals. Their
+// det() and rank() use fraction-free Bareiss elimination. LU needs exact
+// division, so it rejects integers and takes any nonzero pivot instead of the
+// largest one for exact fields such as rationals. Specialize for exact
+// user-defined types.
+template<typename T>
+struct exact_arithmetic : std::is_integral<T> {};
+
+template<typename T>
+class lu_decomposition;
+
+namespace detail {
+
+inline double magnitude(const HasModule auto& value) {
+    return value.module();
+}
+
+inline double magnitude(const auto& value) {
+    return std::abs(value);
+}
+
+// Packed GEMM in the Goto/BLIS layout. A kc x nc panel of B and an mc x kc
+// block of A are copied into zero-padded micro-panels, nr columns and mr rows
+// wide, so that the mr x nr microkernel reads both sequentially while its
+// tile of C stays in registers. kc x nr of B stays in L1, mc x kc of A in L2.
+template<typename T>
+struct gemm_blocking;
+
+template<>
+struct gemm_blocking<double> {
+    static constexpr size_t mr = 6;
+    static constexpr size_t nr = 8;
+    static constexpr size_t mc = 96;
+    static constexpr size_t kc = 256;
+    static constexpr size_t nc = 2048;
+};
+
+template<>
+struct gemm_blocking<float> {
+    static constexpr size_t mr = 6;
+    static constexpr size_t nr = 16;
+    static constexpr size_t mc = 96;
+    static constexpr size_t kc = 256;
+    static constexpr size_t nc = 2048;
+};
+
+template<typename T>
+using gemm_kernel = void (*)(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t m, size_t n, bool accumulate);
+
+// Writes (or adds) the top-left m x n corner of an mr x nr tile to C.
+template<typename T>
+void gemm_store_tile(const T* tile, T* c, size_t ldc, size_t m, size_t n, bool accumulate) {
+    const size_t nr = gemm_blocking<T>::nr;
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            c[i * ldc + j] = accumulate ? c[i * ldc + j] + tile[i * nr + j] : tile[i * nr + j];
+        }
+    }
+}
+
+template<typename T>
+void gemm_micro_generic(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t m, size_t n, bool accumulate) {
+    const size_t mr = gemm_blocking<T>::mr;
+    const size_t nr = gemm_blocking<T>::nr;
+    T tile[mr * nr] = {};
+    for (size_t k = 0; k < kc; ++k) {
+        for (size_t i = 0; i < mr; ++i) {
+            for (size_t j = 0; j < nr; ++j) {
+                tile[i * nr + j] += a[k * mr + i] * b[k * nr + j];
+            }
+        }
+    }
+    gemm_store_tile(tile, c, ldc, m, n, accumulate);
+}
+
+#ifdef LINALG_X86_KERNELS
+
+__attribute__((target("avx2,fma")))
+inline void gemm_micro_avx2(size_t kc, const double* a, const double* b, double* c, size_t ldc, size_t m, size_t n, bool accumulate) {
+    __m256d acc[6][2];
+    for (size_t i = 0; i < 6; ++i) {
+        acc[i][0] = acc[i][1] = _mm256_setzero_pd();
+    }
+    for (size_t k = 0; k < kc; ++k, a += 6, b += 8) {
+        __m256d b0 = _mm256_loadu_pd(b);
+        __m256d b1 = _mm256_loadu_pd(b + 4);
+#pragma GCC unroll 6
+        for (size_t i = 0; i < 6; ++i) {
+            __m256d ai = _mm256_broadcast_sd(a + i);
+            acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+        }
+    }
+    if (m == 6 && n == 8) {
+        for (size_t i = 0; i < 6; ++i) {
+            double* row = c + i * ldc;
+            if (accumulate) {
+                acc[i][0] = _mm256_add_pd(acc[i][0], _mm256_loadu_pd(row));
+                acc[i][1] = _mm256_add_pd(acc[i][1], _mm256_loadu_pd(row + 4));
+            }
+            _mm256_storeu_pd(row, acc[i][0]);
+            _mm256_storeu_pd(row + 4, acc[i][1]);
+        }
+        return;
+    }
+    double tile[6 * 8];
+    for (size_t i = 0; i < 6; ++i) {
+        _mm256_storeu_pd(tile + i * 8, acc[i][0]);
+        _mm256_storeu_pd(tile + i * 8 + 4, acc[i][1]);
+    }
+    gemm_store_tile(tile, c, ldc, m, n, accumulate);
+}
+
+__attribute__((target("avx2,fma")))
+inline void gemm_micro_avx2(size_t kc, const float* a, const float* b, float* c, size_t ldc, size_t m, size_t n, bool accumulate) {
+    __m256 acc[6][2];
+    for (size_t i = 0; i < 6; ++i) {
+        acc[i][0] = acc[i][1] = _mm256_setzero_ps();
+    }
+    for (size_t k = 0; k < kc; ++k, a += 6, b += 16) {
+        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b1 = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 6
+        for (size_t i = 0; i < 6; ++i) {
+            __m256 ai = _mm256_broadcast_ss(a + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+    if (m == 6 && n == 16) {
+        for (size_t i = 0; i < 6; ++i) {
+            float* row = c + i * ldc;
+            if (accumulate) {
+                acc[i][0] = _mm256_add_ps(acc[i][0], _mm256_loadu_ps(row));
+                acc[i][1] = _mm256_add_ps(acc[i][1], _mm256_loadu_ps(row + 8));
+            }
+            _mm256_storeu_ps(row, acc[i][0]);
+            _mm256_storeu_ps(row + 8, acc[i][1]);
+        }
+        return;
+    }
+    float tile[6 * 16];
+    for (size_t i = 0; i < 6; ++i) {
+        _mm256_storeu_ps(tile + i * 16, acc[i][0]);
+        _mm256_storeu_ps(tile + i * 16 + 8, acc[i][1]);
+    }
+    gemm_store_tile(tile, c, ldc, m, n, accumulate);
+}
+
+#endif
+
+template<typename T>
+gemm_kernel<T> select_gemm_kernel() {
+#ifdef LINALG_X86_KERNELS
+    static const bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (has_avx2) {
+        return static_cast<gemm_kernel<T>>(gemm_micro_avx2);
+    }
+#endif
+    return gemm_micro_generic<T>;
+}
+
+// Copies rows [0, mc) and columns [0, kc) of A, negated if asked, into mr-row
+// micro-panels, column by column, padding the last panel with zeros.
+template<typename T>
+void gemm_pack_a(size_t mc, size_t kc, const T* a, size_t lda, bool negate, T* dst) {
+    const size_t mr = gemm_blocking<T>::mr;
+    for (size_t i0 = 0; i0 < mc; i0 += mr) {
+        size_t m = std::min(mr, mc - i0);
+        for (size_t k = 0; k < kc; ++k) {
+            for (size_t i = 0; i < mr; ++i) {
+                *dst++ = i < m ? (negate ? -a[(i0 + i) * lda + k] : a[(i0 + i) * lda + k]) : T(0);
+            }
+        }
+    }
+}
+
+// Copies rows [0, kc) and columns [0, nc) of B into nr-column micro-panels,
+// row by row, padding the last panel with zeros.
+template<typename T>
+void gemm_pack_b(size_t kc, size_t nc, const T* b, size_t ldb, T* dst) {
+    const size_t nr = gemm_blocking<T>::nr;
+    for (size_t j0 = 0; j0 < nc; j0 += nr) {
+        size_t n = std::min(nr, nc - j0);
+        for (size_t k = 0; k < kc; ++k) {
+            const T* row = b + k * ldb + j0;
+            for (size_t j = 0; j < nr; ++j) {
+                *dst++ = j < n ? row[j] : T(0);
+            }
+        }
+    }
+}
+
+// C = A * B, or C -= A * B if subtract is set, for row-major A (m x k),
+// B (k x n) and C (m x n) with rows lda, ldb and ldc elements apart. For each
+// kc-deep slice the panels are packed once, in parallel, and the tasks (an
+// mc-row block of A times a run of B's micro-panels) are spread over the pool.
+template<typename T>
+void gemm(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb,
+          T* c, size_t ldc, bool subtract) {
+    using blocking = gemm_blocking<T>;
+    if (k == 0) {
+        for (size_t i = 0; i < m && !subtract; ++i) {
+            std::fill(c + i * ldc, c + i * ldc + n, T(0));
+        }
+        return;
+    }
+
+    static const gemm_kernel<T> kernel = select_gemm_kernel<T>();
+    const size_t jr_run = 32 * blocking::nr;
+    size_t m_padded = (m + blocking::mr - 1) / blocking::mr * blocking::mr;
+    size_t nc_max = (std::min(blocking::nc, n) + blocking::nr - 1) / blocking::nr * blocking::nr;
+    std::vector<T> packed_a(m_padded * std::min(blocking::kc, k));
+    std::vector<T> packed_b(nc_max * std::min(blocking::kc, k));
+
+    for (size_t jc = 0; jc < n; jc += blocking::nc) {
+        size_t nc = std::min(blocking::nc, n - jc);
+        for (size_t pc = 0; pc < k; pc += blocking::kc) {
+            size_t kc = std::min(blocking::kc, k - pc);
+            size_t b_panels = (nc + blocking::nr - 1) / blocking::nr;
+            parallel_for(b_panels, kc * blocking::nr, [&](size_t begin, size_t end) {
+                size_t j0 = begin * blocking::nr;
+                size_t j1 = std::min(end * blocking::nr, nc);
+                gemm_pack_b(kc, j1 - j0, b + pc * ldb + jc + j0, ldb, packed_b.data() + j0 * kc);
+            });
+            size_t a_panels = m_padded / blocking::mr;
+            parallel_for(a_panels, kc * blocking::mr, [&](size_t begin, size_t end) {
+                size_t i0 = begin * blocking::mr;
+                size_t i1 = std::min(end * blocking::mr, m);
+                gemm_pack_a(i1 - i0, kc, a + i0 * lda + pc, lda, subtract, packed_a.data() + i0 * kc);
+            });
+
+            size_t ic_blocks = (m + blocking::mc - 1) / blocking::mc;
+            size_t jr_runs = (nc + jr_run - 1) / jr_run;
+            size_t task_work = blocking::mc * kc * std::min(jr_run, nc);
+            parallel_for(ic_blocks * jr_runs, task_work, [&](size_t begin, size_t end) {
+                for (size_t task = begin; task < end; ++task) {
+                    size_t ic = task / jr_runs * blocking::mc;
+                    size_t mc = std::min(blocking::mc, m - ic);
+                    size_t jr_begin = task % jr_runs * jr_run;
+                    size_t jr_end = std::min(jr_begin + jr_run, nc);
+                    for (size_t jr = jr_begin; jr < jr_end; jr += blocking::nr) {
+                        for (size_t ir = 0; ir < mc; ir += blocking::mr) {
+                            kernel(kc, packed_a.data() + (ic + ir) * kc, packed_b.data() + jr * kc,
+                                   c + (ic + ir) * ldc + jc + jr, ldc,
+                                   std::min(blocking::mr, mc - ir), std::min(blocking::nr, nc - jr),
+                                   subtract || pc > 0);
+                        }
+                    }
+                }
+            });
+        }
+    }
+}
+
+template<typename T>
+void gemm(size_t m, size_t n, size_t k, const T* a, const T* b, T* c) {
+    gemm(m, n, k, a, k, b, n, c, n, false);
+}
+
+// Element types the packed GEMM kernels are written for.
+template<typename T>
+constexpr bool has_gemm_kernel = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Writes the transpose of the rows x cols block at src into dst.
+template<typename T>
+void transpose_block(size_t rows, size_t cols, const T* src, size_t lds, T* dst, size_t ldd) {
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+}
+
+#ifdef LINALG_X86_KERNELS
+// 4x4 (float) and 2x2 (double) squares are transposed in registers with SSE
+// shuffles, which every x86-64 has; ragged edges go element by element.
+template<>
+inline void transpose_block<float>(size_t rows, size_t cols, const float* src, size_t lds, float* dst, size_t ldd) {
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        size_t j = 0;
+        for (; j + 4 <= cols; j += 4) {
+            const float* s = src + i * lds + j;
+            __m128 r0 = _mm_loadu_ps(s);
+            __m128 r1 = _mm_loadu_ps(s + lds);
+            __m128 r2 = _mm_loadu_ps(s + 2 * lds);
+            __m128 r3 = _mm_loadu_ps(s + 3 * lds);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            float* d = dst + j * ldd + i;
+            _mm_storeu_ps(d, r0);
+            _mm_storeu_ps(d + ldd, r1);
+            _mm_storeu_ps(d + 2 * ldd, r2);
+            _mm_storeu_ps(d + 3 * ldd, r3);
+        }
+        for (; j < cols; ++j) {
+            for (size_t k = 0; k < 4; ++k) {
+                dst[j * ldd + i + k] = src[(i + k) * lds + j];
+            }
+        }
+    }
+    for (; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+}
+
+template<>
+inline void transpose_block<double>(size_t rows, size_t cols, const double* src, size_t lds, double* dst, size_t ldd) {
+    size_t i = 0;
+    for (; i + 2 <= rows; i += 2) {
+        size_t j = 0;
+        for (; j + 2 <= cols; j += 2) {
+            __m128d r0 = _mm_loadu_pd(src + i * lds + j);
+            __m128d r1 = _mm_loadu_pd(src + (i + 1) * lds + j);
+            _mm_storeu_pd(dst + j * ldd + i, _mm_unpacklo_pd(r0, r1));
+            _mm_storeu_pd(dst + (j + 1) * ldd + i, _mm_unpackhi_pd(r0, r1));
+        }
+        for (; j < cols; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+            dst[j * ldd + i + 1] = src[(i + 1) * lds + j];
+        }
+    }
+    for (; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            dst[j * ldd + i] = src[i * lds + j];
+        }
+    }
+}
+#endif
+
+// Side of the square tiles transposes are done in: a tile of the source and
+// one of the destination together stay in L1, so neither side is walked with
+// a stride of a whole row per element.
+constexpr size_t transpose_tile = 32;
+
+// dst (cols x rows) = src^T for row-major src (rows x cols), with rows lds and
+// ldd elements apart. Threads take disjoint bands of dst rows.
+template<typename T>
+void transpose(size_t rows, size_t cols, const T* src, size_t lds, T* dst, size_t ldd) {
+    size_t bands = (cols + transpose_tile - 1) / transpose_tile;
+    parallel_for(bands, rows * transpose_tile, [&](size_t begin, size_t end) {
+        for (size_t band = begin; band < end; ++band) {
+            size_t j0 = band * transpose_tile;
+            size_t width = std::min(transpose_tile, cols - j0);
+            for (size_t i0 = 0; i0 < rows; i0 += transpose_tile) {
+                transpose_block(std::min(transpose_tile, rows - i0), width,
+                                src + i0 * lds + j0, lds, dst + j0 * ldd + i0, ldd);
+            }
+        }
+    });
+}
+
+// In-place transpose of a square n x n matrix, swapping mirrored tiles.
+template<typename T>
+void transpose_square(size_t n, T* a) {
+    size_t tiles = (n + transpose_tile - 1) / transpose_tile;
+    parallel_for(tiles, n * transpose_tile / 2, [&](size_t begin, size_t end) {
+        using std::swap;
+        for (size_t ti = begin; ti < end; ++ti) {
+            size_t i0 = ti * transpose_tile;
+            size_t i1 = std::min(i0 + transpose_tile, n);
+            for (size_t j0 = i0; j0 < n; j0 += transpose_tile) {
+                size_t j1 = std::min(j0 + transpose_tile, n);
+                for (size_t i = i0; i < i1; ++i) {
+                    for (size_t j = std::max(j0, i + 1); j < j1; ++j) {
+                        swap(a[i * n + j], a[j * n + i]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+// In-place transpose of a rows x cols matrix by following the cycles of the
+// permutation that sends element i * cols + j to j * rows + i. Needs one bit
+// per element to mark the ones already moved, and runs on one thread.
+template<typename T>
+void transpose_cycles(size_t rows, size_t cols, T* a) {
+    size_t count = rows * cols;
+    if (count < 3) {
+        return;
+    }
+    using std::swap;
+    std::vector<bool> moved(count);
+    for (size_t start = 1; start + 1 < count; ++start) {
+        if (moved[start]) {
+            continue;
+        }
+        T value = std::move(a[start]);
+        size_t current = start;
+        do {
+            size_t next = (current % cols) * rows + current / cols;
+            swap(value, a[next]);
+            moved[next] = true;
+            current = next;
+        } while (current != start);
+    }
+}
+
+} // namespace detail
+
 template<typename T>
 class Matrix {
     public:
@@ -99,10 +512,16 @@ class Matrix {
 
     T det() const;
 
+    size_t rank() const;
+
     Matrix inversed() const;
 
     Matrix transposed() const;
 
+    // Transposes in place: tile by tile for square matrices, by following
+    // permutation cycles (serially, one bit of scratch per element) otherwise.
+    void transpose();
+
     private:
 
     T* m_ptr = nullptr;
@@ -113,7 +532,14 @@ class Matrix {
     template<typename U>
     void free(U*& ptr, size_t n) noexcept;
 
-    T recursive_determinant(const T* ptr, size_t n) const;
+    // Storage for rows x columns elements left uninitialized; only for
+    // trivial T whose every element is about to be overwritten.
+    static Matrix uninitialized(size_t rows, size_t columns);
+
+    // Determinant (rank) by fraction-free elimination of a copy, for exact T.
+    T bareiss_determinant() const;
+
+    size_t bareiss_rank() const;
 
     template<typename U, typename Y>
     static bool are_equal (const U& a, const Y& b) { return a == b; } 
@@ -127,14 +553,6 @@ class Matrix {
     static bool are_equal (const U& a, const double& b, double epsilon = 1e-9) { 
         return std::fabs(a - b) < epsilon; 
     }
-
-    static double abs(const HasModule auto& value) {
-        return value.module();
-    }
-
-    static double abs(const auto& value) {
-        return std::abs(value);
-    }
 };
 
 template<typename T>
@@ -298,10 +716,11 @@ Matrix<T>& Matrix<T>::operator=(Matrix<U>&& other) noexcept {
     delete[] reinterpret_cast<std::byte*>(m_ptr);
     m_rows = other.m_rows;
     m_columns = other.m_columns;
+    m_capacity = other.m_capacity;
     m_ptr = reinterpret_cast<T*>(other.m_ptr);
 
     other.m_ptr = nullptr;
-    other.m_columns = other.m_rows = 0;
+    other.m_columns = other.m_rows = other.m_capacity = 0;
 
     return *this;
 }
@@ -313,9 +732,11 @@ Matrix<T>& Matrix<T>::operator+=(const Matrix<U>& other) {
         throw std::runtime_error("Incompatible sizes");
     }
 
-    for (size_t i = 0; i < size(); ++i) {
-        m_ptr[i] += other.m_ptr[i];
-    }
+    parallel_for(size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_ptr[i] += other.m_ptr[i];
+        }
+    });
 
     return *this;
 }
@@ -327,9 +748,11 @@ Matrix<T>& Matrix<T>::operator-=(const Matrix<U>& other) {
         throw std::runtime_error("Incompatible sizes");
     }
 
-    for (size_t i = 0; i < size(); ++i) {
-        m_ptr[i] -= other.m_ptr[i];
-    }
+    parallel_for(size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_ptr[i] -= other.m_ptr[i];
+        }
+    });
 
     return *this;
 }
@@ -341,6 +764,13 @@ Matrix<T>& Matrix<T>::operator*=(const Matrix<U>& other) {
         throw std::runtime_error("Incompatible sizes");
     }
 
+    if constexpr (std::is_same_v<T, U> && detail::has_gemm_kernel<T>) {
+        Matrix<T> res = uninitialized(m_rows, other.m_columns);
+        detail::gemm(m_rows, other.m_columns, m_columns, m_ptr, other.m_ptr, res.m_ptr);
+        swap(res);
+        return *this;
+    }
+
     Matrix<T> res;
     try {
         res = Matrix<T>(m_rows, other.m_columns);
@@ -348,24 +778,32 @@ Matrix<T>& Matrix<T>::operator*=(const Matrix<U>& other) {
         throw;
     }    
 
-    for (size_t i = 0; i < m_rows; ++i) {
-        for (size_t j = 0; j < other.m_columns; ++j) {
+    // i-k-j order: the innermost loop runs along rows of other and res.
+    parallel_for(m_rows, m_columns * other.m_columns, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            T* res_row = res.m_ptr + i * other.m_columns;
             for (size_t k = 0; k < m_columns; ++k) {
-                res(i,j) += (*this)(i, k) * other(k,j);
+                const T& lhs = m_ptr[i * m_columns + k];
+                const U* other_row = other.m_ptr + k * other.m_columns;
+                for (size_t j = 0; j < other.m_columns; ++j) {
+                    res_row[j] += lhs * other_row[j];
+                }
             }
         }
-    }
+    });
 
-    *this = std::move(res);
+    swap(res);
     return *this;
 }
 
 template<typename T>
 template<typename U>
 Matrix<T>& Matrix<T>::operator*=(U num) noexcept {
-    for (size_t i = 0; i < size(); ++i) {
-        m_ptr[i] *= num;
-    }
+    parallel_for(size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_ptr[i] *= num;
+        }
+    });
 
     return *this;
 }
@@ -462,135 +900,695 @@ void Matrix<T>::free(U*& ptr, size_t n) noexcept {
     ptr = nullptr;
 }
 
+template<typename T>
+Matrix<T> Matrix<T>::uninitialized(size_t rows, size_t columns) {
+    static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>);
+    Matrix<T> res;
+    res.m_ptr = reinterpret_cast<T*>(new std::byte[rows * columns * sizeof(T)]);
+    res.m_rows = rows;
+    res.m_columns = columns;
+    res.m_capacity = rows * columns;
+    return res;
+}
+
 template<typename T>
 T Matrix<T>::det() const {
     if (m_columns != m_rows || m_columns * m_rows == 0) {
         throw std::runtime_error("Not a square matrix");
     }
-    return Matrix::recursive_determinant(m_ptr, m_rows);
+    if constexpr (exact_arithmetic<T>::value) {
+        return bareiss_determinant();
+    } else {
+        return lu_decomposition<T>(*this).det();
+    }
 }
 
 template<typename T>
-T Matrix<T>::recursive_determinant(const T* ptr, size_t n) const {
-    if (n == 1) {
-        return ptr[0];
+size_t Matrix<T>::rank() const {
+    if constexpr (exact_arithmetic<T>::value) {
+        return bareiss_rank();
+    } else {
+        return lu_decomposition<T>(*this, true).rank();
     }
+}
 
-    T det = 0;
+template<typename T>
+T Matrix<T>::bareiss_determinant() const {
+    size_t n = m_rows;
+    std::vector<T> a(m_ptr, m_ptr + size());
+    T sign = 1;
+    T prev = 1;
+    for (size_t k = 0; k < n; ++k) {
+        if (a[k * n + k] == T(0)) {
+            size_t p = k + 1;
+            while (p < n && a[p * n + k] == T(0)) {
+                ++p;
+            }
+            if (p == n) {
+                return T(0);
+            }
+            std::swap_ranges(a.begin() + k * n, a.begin() + (k + 1) * n, a.begin() + p * n);
+            sign = -sign;
+        }
+        // Every entry of the updated block is a minor of the original matrix,
+        // so the division by the previous pivot is exact.
+        for (size_t i = k + 1; i < n; ++i) {
+            for (size_t j = k + 1; j < n; ++j) {
+                a[i * n + j] = (a[i * n + j] * a[k * n + k] - a[i * n + k] * a[k * n + j]) / prev;
+            }
+        }
+        prev = a[k * n + k];
+    }
+    return sign * a[n * n - 1];
+}
 
-    try {
-        std::vector<T> submatrix((n - 1) * (n - 1));
-        for (int k = 0; k < n; ++k) {
-            for (int i = 1; i < n; ++i) {
-                int sub_i = i - 1;
-                for (int j = 0, sub_j = 0; j < n; ++j) {
-                    if (j == k) continue;
-                    submatrix[sub_i * (n - 1) + sub_j] = ptr[i * n + j];
-                    ++sub_j;
-                }
+template<typename T>
+size_t Matrix<T>::bareiss_rank() const {
+    size_t rows = m_rows;
+    size_t cols = m_columns;
+    std::vector<T> a(m_ptr, m_ptr + size());
+    T prev = 1;
+    size_t rank = 0;
+    for (size_t k = 0; k < cols && rank < rows; ++k) {
+        size_t p = rank;
+        while (p < rows && a[p * cols + k] == T(0)) {
+            ++p;
+        }
+        if (p == rows) {
+            continue;
+        }
+        std::swap_ranges(a.begin() + rank * cols, a.begin() + (rank + 1) * cols, a.begin() + p * cols);
+        T pivot = a[rank * cols + k];
+        for (size_t i = rank + 1; i < rows; ++i) {
+            for (size_t j = k + 1; j < cols; ++j) {
+                a[i * cols + j] = (a[i * cols + j] * pivot - a[i * cols + k] * a[rank * cols + j]) / prev;
             }
+            a[i * cols + k] = T(0);
+        }
+        prev = pivot;
+        ++rank;
+    }
+    return rank;
+}
+
+template <typename T>
+Matrix<T> Matrix<T>::inversed() const {
+    if (m_rows != m_columns) {
+        throw std::runtime_error("Matrix is not square, cannot compute inverse.");
+    }
+    return lu_decomposition<T>(*this).inverse();
+}
 
-            T sign = (k % 2 == 0) ? 1 : -1;
+template <typename T>
+Matrix<T> Matrix<T>::transposed() const {
+    Matrix<T> transposed;
 
-            det += sign * ptr[k] * recursive_determinant(submatrix.data(), n - 1);
+    try {
+        if constexpr (std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>) {
+            transposed = uninitialized(m_columns, m_rows);
+        } else {
+            transposed = Matrix<T>(m_columns, m_rows);
         }
+        detail::transpose(m_rows, m_columns, m_ptr, m_columns, transposed.m_ptr, m_rows);
     } catch(...) {
         throw;
     }
 
-    return det;
+    return transposed;
 }
 
 template <typename T>
-Matrix<T> Matrix<T>::inversed() const {
-    size_t n = m_rows;
-    if (n != m_columns) {
-        throw std::runtime_error("Matrix is not square, cannot compute inverse.");
+void Matrix<T>::transpose() {
+    if (m_rows == m_columns) {
+        detail::transpose_square(m_rows, m_ptr);
+    } else {
+        detail::transpose_cycles(m_rows, m_columns, m_ptr);
+        std::swap(m_rows, m_columns);
     }
+}
 
-    T det = this->det();
-    if (det == T(0)) {
-        throw std::runtime_error("Matrix is singular, cannot compute inverse.");
+// PA = LU with partial pivoting, computed once and reused for det(), rank(),
+// solve() and inverse(). L (unit diagonal, not stored) and U share one
+// matrix. Columns without a pivot are skipped, so rectangular and singular
+// matrices factor into echelon form and rank() counts the pivots; det() of a
+// singular matrix is 0, solve() and inverse() throw. Like getrf, only an
+// exactly zero pivot is missing, so a badly scaled matrix keeps its det().
+//
+// With skip_negligible, which Matrix::rank() uses, a floating pivot also
+// counts as zero below a few ulps of the largest absolute row sum of A or of
+// U so far, so that rounding amplified by element growth is not mistaken for
+// rank. Partial pivoting does not reveal rank, though: for a matrix only a
+// rounding away from deficient, rank() may still exceed the numerical rank
+// an SVD would give.
+//
+// Exact fields, such as rationals, take the first nonzero pivot. Integers
+// would truncate the multipliers and are rejected: Matrix::det() and rank()
+// use Bareiss elimination for them, solve() and inverse() do not compile.
+template<typename T>
+class lu_decomposition {
+    static_assert(!std::is_integral_v<T>, "LU needs exact division, integers would truncate");
+
+    public:
+
+    explicit lu_decomposition(const Matrix<T>& matrix, bool skip_negligible = false)
+        : lu_decomposition(Matrix<T>(matrix), skip_negligible) {}
+
+    // Factors in the storage of matrix instead of a copy.
+    explicit lu_decomposition(Matrix<T>&& matrix, bool skip_negligible = false);
+
+    size_t rank() const noexcept { return m_rank; }
+
+    bool singular() const noexcept { return m_rank < std::min(m_lu.rows(), m_lu.columns()) || m_lu.rows() != m_lu.columns(); }
+
+    T det() const;
+
+    // X with AX = B, for square nonsingular A.
+    Matrix<T> solve(const Matrix<T>& b) const;
+
+    Matrix<T> inverse() const&;
+
+    // Inverts in the storage of the factorization, which is consumed.
+    Matrix<T> inverse() &&;
+
+    const Matrix<T>& packed() const noexcept { return m_lu; }
+
+    // Row i of PA is row permutation()[i] of A.
+    const std::vector<size_t>& permutation() const noexcept { return m_perm; }
+
+    private:
+
+    static constexpr size_t block_size = 64;
+
+    size_t factor_blocked();
+
+    void factor_unblocked(size_t first_column);
+
+    void swap_rows(size_t first, size_t second);
+
+    // Raises the tolerance to cover a row of U, or the part of it computed so
+    // far, in [first, last) of row.
+    void grow(const T* row, size_t first, size_t last);
+
+    Matrix<T> m_lu;
+    std::vector<size_t> m_perm;
+    size_t m_rank = 0;
+    bool m_odd_swaps = false;
+    double m_tolerance = 0;
+    double m_ulps = 0;
+};
+
+template<typename T>
+lu_decomposition<T>::lu_decomposition(Matrix<T>&& matrix, bool skip_negligible)
+    : m_lu(std::move(matrix)), m_perm(m_lu.rows()) {
+    size_t rows = m_lu.rows();
+    size_t cols = m_lu.columns();
+    for (size_t i = 0; i < rows; ++i) {
+        m_perm[i] = i;
     }
 
-    Matrix<T> augmented;
-    try {
-        augmented = Matrix<T>(n, 2 * n);
-        for (int i = 0; i < n; ++i) {
-            for (int j = 0; j < n; ++j) {
-                augmented(i, j) = operator()(i, j);
-                augmented(i, j + n) = (i == j) ? T(1) : T(0); 
+    // Pivots at or below tolerance count as zero: a few ulps of the infinity
+    // norm when skipping negligible ones, exactly zero otherwise.
+    if constexpr (!exact_arithmetic<T>::value) {
+        if (skip_negligible) {
+            m_ulps = std::max(rows, cols) * std::numeric_limits<double>::epsilon();
+            for (size_t i = 0; i < rows; ++i) {
+                grow(m_lu.begin() + i * cols, 0, cols);
             }
         }
-    } catch(...) {
-        throw;
     }
 
-    for (int i = 0; i < n; ++i) {
-        int max_row = i;
-        for (int j = i + 1; j < n; ++j) {
-            if (abs(augmented(j, i)) > abs(augmented(max_row, i))) {
-                max_row = j;
-            }
+    size_t column = 0;
+    if constexpr (detail::has_gemm_kernel<T>) {
+        if (rows == cols) {
+            column = factor_blocked();
         }
+    }
+    factor_unblocked(column);
+}
 
-        for (int j = 0; j < 2 * n; ++j) {
-            std::swap(augmented(i, j), augmented(max_row, j));
+template<typename T>
+void lu_decomposition<T>::swap_rows(size_t first, size_t second) {
+    size_t cols = m_lu.columns();
+    T* a = m_lu.begin();
+    std::swap_ranges(a + first * cols, a + (first + 1) * cols, a + second * cols);
+    std::swap(m_perm[first], m_perm[second]);
+    m_odd_swaps = !m_odd_swaps;
+}
+
+// Partial pivoting keeps L bounded by 1, so the rounding the elimination
+// leaves in the trailing matrix scales with the rows of U, which can outgrow
+// those of A. A rank-deficient trailing block is left holding that rounding,
+// and an entrywise bound takes it for pivots.
+template<typename T>
+void lu_decomposition<T>::grow(const T* row, size_t first, size_t last) {
+    if constexpr (!exact_arithmetic<T>::value) {
+        double sum = 0;
+        for (size_t j = first; j < last; ++j) {
+            sum += detail::magnitude(row[j]);
         }
+        m_tolerance = std::max(m_tolerance, sum * m_ulps);
+    }
+}
 
-        T pivot = augmented(i, i);
-        if (pivot == T(0)) {
-            throw std::invalid_argument("Matrix is singular, cannot compute inverse.");
+// Right-looking blocked LU of a square matrix: each block_size-wide panel is
+// factored on its own, then the block row of U to its right is found by
+// substitution and the trailing matrix gets a single GEMM update. Stops at
+// the first pivot under tolerance, with all columns to the right brought up
+// to date, and returns its column; the unblocked loop takes over from there.
+template<typename T>
+size_t lu_decomposition<T>::factor_blocked() {
+    size_t n = m_lu.rows();
+    T* a = m_lu.begin();
+    for (size_t k0 = 0; k0 < n; k0 += block_size) {
+        size_t nb = std::min(block_size, n - k0);
+        size_t right = k0 + nb;
+        size_t done = 0;
+        for (; done < nb; ++done) {
+            size_t k = k0 + done;
+            size_t p = k;
+            double best = detail::magnitude(a[k * n + k]);
+            for (size_t i = k + 1; i < n; ++i) {
+                double value = detail::magnitude(a[i * n + k]);
+                if (value > best) {
+                    best = value;
+                    p = i;
+                }
+            }
+            if (best <= m_tolerance) {
+                break;
+            }
+            if (p != k) {
+                swap_rows(k, p);
+            }
+            grow(a + k * n, k, right);
+            const T pivot = a[k * n + k];
+            parallel_for(n - k - 1, right - k, [&](size_t begin, size_t end) {
+                for (size_t i = k + 1 + begin; i < k + 1 + end; ++i) {
+                    T factor = a[i * n + k] / pivot;
+                    a[i * n + k] = factor;
+                    for (size_t j = k + 1; j < right; ++j) {
+                        a[i * n + j] -= factor * a[k * n + j];
+                    }
+                }
+            });
+            ++m_rank;
         }
 
-        for (int j = 0; j < 2 * n; ++j) {
-            augmented(i, j) /= pivot;
+        if (done > 0 && right < n) {
+            parallel_for(n - right, done * done, [&](size_t begin, size_t end) {
+                for (size_t i = 1; i < done; ++i) {
+                    T* row = a + (k0 + i) * n + right;
+                    for (size_t p = 0; p < i; ++p) {
+                        const T factor = a[(k0 + i) * n + k0 + p];
+                        const T* other = a + (k0 + p) * n + right;
+                        for (size_t j = begin; j < end; ++j) {
+                            row[j] -= factor * other[j];
+                        }
+                    }
+                }
+            });
+            for (size_t i = 0; i < done; ++i) {
+                grow(a + (k0 + i) * n, k0 + i, n);
+            }
+            detail::gemm(n - k0 - done, n - right, done, a + (k0 + done) * n + k0, n,
+                         a + k0 * n + right, n, a + (k0 + done) * n + right, n, true);
+        }
+        if (done < nb) {
+            return k0 + done;
         }
+    }
+    return n;
+}
 
-        for (int k = 0; k < n; ++k) {
-            if (k != i) {
-                T factor = augmented(k, i);
-                for (int j = 0; j < 2 * n; ++j) {
-                    augmented(k, j) -= factor * augmented(i, j);
+template<typename T>
+void lu_decomposition<T>::factor_unblocked(size_t first_column) {
+    size_t rows = m_lu.rows();
+    size_t cols = m_lu.columns();
+    T* a = m_lu.begin();
+    for (size_t k = first_column; k < cols && m_rank < rows; ++k) {
+        size_t r = m_rank;
+        size_t p = r;
+        if constexpr (exact_arithmetic<T>::value) {
+            while (p < rows && a[p * cols + k] == T(0)) {
+                ++p;
+            }
+            if (p == rows) {
+                continue;
+            }
+        } else {
+            double best = detail::magnitude(a[r * cols + k]);
+            for (size_t i = r + 1; i < rows; ++i) {
+                double value = detail::magnitude(a[i * cols + k]);
+                if (value > best) {
+                    best = value;
+                    p = i;
                 }
             }
+            if (best <= m_tolerance) {
+                continue;
+            }
+        }
+        if (p != r) {
+            swap_rows(r, p);
         }
+        grow(a + r * cols, k, cols);
+
+        const T pivot = a[r * cols + k];
+        parallel_for(rows - r - 1, cols - k, [&](size_t begin, size_t end) {
+            for (size_t i = r + 1 + begin; i < r + 1 + end; ++i) {
+                T* row = a + i * cols;
+                const T* pivot_row = a + r * cols;
+                T factor = row[k] / pivot;
+                row[k] = factor;
+                for (size_t j = k + 1; j < cols; ++j) {
+                    row[j] -= factor * pivot_row[j];
+                }
+            }
+        });
+        ++m_rank;
     }
+}
 
+template<typename T>
+T lu_decomposition<T>::det() const {
+    size_t n = m_lu.rows();
+    if (n != m_lu.columns()) {
+        throw std::runtime_error("Not a square matrix");
+    }
+    if (m_rank < n) {
+        return T(0);
+    }
+    T res = m_odd_swaps ? T(-1) : T(1);
+    for (size_t i = 0; i < n; ++i) {
+        res *= m_lu(i, i);
+    }
+    return res;
+}
 
-    Matrix<T> inv;
-    try {
-        inv = Matrix<T>(n, n);
-        for (int i = 0; i < n; ++i) {
-            for (int j = 0; j < n; ++j) {
-                inv(i, j) = augmented(i, j + n);
+template<typename T>
+Matrix<T> lu_decomposition<T>::solve(const Matrix<T>& b) const {
+    size_t n = m_lu.rows();
+    if (n != m_lu.columns()) {
+        throw std::runtime_error("Matrix is not square, cannot solve.");
+    }
+    if (b.rows() != n) {
+        throw std::runtime_error("Incompatible sizes");
+    }
+    if (m_rank < n) {
+        throw std::runtime_error("Matrix is singular, cannot solve.");
+    }
+
+    size_t k = b.columns();
+    Matrix<T> x(n, k);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            x(i, j) = b(m_perm[i], j);
+        }
+    }
+
+    // Substitutions run row by row over all right-hand sides at once; the
+    // columns are independent and are split between threads.
+    T* xs = x.begin();
+    parallel_for(k, 2 * n * n, [&](size_t begin, size_t end) {
+        for (size_t i = 0; i < n; ++i) {
+            T* row = xs + i * k;
+            for (size_t p = 0; p < i; ++p) {
+                const T factor = m_lu(i, p);
+                const T* other = xs + p * k;
+                for (size_t j = begin; j < end; ++j) {
+                    row[j] -= factor * other[j];
+                }
             }
         }
-    } catch(...) {
-        throw;
+        for (size_t i = n; i-- > 0;) {
+            T* row = xs + i * k;
+            for (size_t p = i + 1; p < n; ++p) {
+                const T factor = m_lu(i, p);
+                const T* other = xs + p * k;
+                for (size_t j = begin; j < end; ++j) {
+                    row[j] -= factor * other[j];
+                }
+            }
+            const T pivot = m_lu(i, i);
+            for (size_t j = begin; j < end; ++j) {
+                row[j] /= pivot;
+            }
+        }
+    });
+    return x;
+}
+
+template<typename T>
+Matrix<T> lu_decomposition<T>::inverse() const& {
+    lu_decomposition copy(*this);
+    return std::move(copy).inverse();
+}
+
+// A^-1 = U^-1 L^-1 P, as in LAPACK's getri: U is inverted in place, then
+// X L = U^-1 is solved for X column by column from the right, and finally
+// the columns of X are permuted. Only a row of scratch space is needed.
+template<typename T>
+Matrix<T> lu_decomposition<T>::inverse() && {
+    size_t n = m_lu.rows();
+    if (n != m_lu.columns()) {
+        throw std::runtime_error("Matrix is not square, cannot compute inverse.");
+    }
+    if (m_rank < n) {
+        throw std::runtime_error("Matrix is singular, cannot compute inverse.");
+    }
+    T* a = m_lu.begin();
+
+    // Row i of U^-1 is (e_i - sum over p > i of U(i, p) * row p of U^-1) / U(i, i).
+    std::vector<T> row(n);
+    for (size_t i = n; i-- > 0;) {
+        std::fill(row.begin() + i, row.end(), T(0));
+        row[i] = T(1);
+        for (size_t p = i + 1; p < n; ++p) {
+            const T factor = a[i * n + p];
+            const T* other = a + p * n;
+            for (size_t j = p; j < n; ++j) {
+                row[j] -= factor * other[j];
+            }
+        }
+        const T pivot = a[i * n + i];
+        for (size_t j = i; j < n; ++j) {
+            a[i * n + j] = row[j] / pivot;
+        }
     }
 
-    return inv;
+    // Column j of X is column j of U^-1 minus X(:, j+1..n) times L(j+1..n, j);
+    // L's column is moved out first since X's column takes its place.
+    std::vector<T>& l_column = row;
+    for (size_t j = n; j-- > 0;) {
+        for (size_t i = j + 1; i < n; ++i) {
+            l_column[i] = a[i * n + j];
+            a[i * n + j] = T(0);
+        }
+        parallel_for(n, n - j, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                T* x = a + i * n;
+                T sum = x[j];
+                for (size_t p = j + 1; p < n; ++p) {
+                    sum -= x[p] * l_column[p];
+                }
+                x[j] = sum;
+            }
+        });
+    }
+
+    parallel_for(n, n, [&](size_t begin, size_t end) {
+        std::vector<T> permuted(n);
+        for (size_t i = begin; i < end; ++i) {
+            T* x = a + i * n;
+            for (size_t j = 0; j < n; ++j) {
+                permuted[m_perm[j]] = x[j];
+            }
+            std::copy(permuted.begin(), permuted.end(), x);
+        }
+    });
+    return std::move(m_lu);
 }
 
-template <typename T>
-Matrix<T> Matrix<T>::transposed() const {
-    Matrix<T> transposed;
+// A = LL^T for symmetric positive definite A: half the work of LU and no
+// pivoting. Only the lower triangle of A is read and L replaces it. Blocked
+// like lu_decomposition, with the trailing update done by GEMM.
+template<typename T>
+class cholesky_decomposition {
+    static_assert(std::is_floating_point_v<T>, "Cholesky factorization needs a real floating type");
 
-    try {
-        transposed = Matrix<T>(m_columns, m_rows);
+    public:
+
+    explicit cholesky_decomposition(const Matrix<T>& matrix) : cholesky_decomposition(Matrix<T>(matrix)) {}
+
+    // Factors in the storage of matrix instead of a copy.
+    explicit cholesky_decomposition(Matrix<T>&& matrix);
+
+    T det() const;
+
+    // X with AX = B.
+    Matrix<T> solve(const Matrix<T>& b) const;
+
+    Matrix<T> inverse() const;
+
+    // L, with zeros above the diagonal.
+    const Matrix<T>& packed() const noexcept { return m_l; }
 
-        for (size_t i = 0; i < m_rows; ++i) {
-            for (size_t j = 0; j < m_columns; ++j) {
-                transposed(j, i) = operator()(i, j);
+    private:
+
+    static constexpr size_t block_size = 64;
+
+    Matrix<T> m_l;
+};
+
+template<typename T>
+cholesky_decomposition<T>::cholesky_decomposition(Matrix<T>&& matrix) : m_l(std::move(matrix)) {
+    size_t n = m_l.rows();
+    if (n != m_l.columns()) {
+        throw std::runtime_error("Not a square matrix");
+    }
+    T* a = m_l.begin();
+    std::vector<T> transposed;
+
+    for (size_t k0 = 0; k0 < n; k0 += block_size) {
+        size_t nb = std::min(block_size, n - k0);
+        size_t right = k0 + nb;
+
+        for (size_t j = k0; j < right; ++j) {
+            if (!(a[j * n + j] > T(0))) {
+                throw std::runtime_error("Matrix is not positive definite");
+            }
+            T diag = std::sqrt(a[j * n + j]);
+            a[j * n + j] = diag;
+            for (size_t i = j + 1; i < right; ++i) {
+                a[i * n + j] /= diag;
+            }
+            for (size_t i = j + 1; i < right; ++i) {
+                for (size_t c = j + 1; c <= i; ++c) {
+                    a[i * n + c] -= a[i * n + j] * a[c * n + j];
+                }
             }
         }
-    } catch(...) {
-        throw;
+
+        // L21 = A21 L11^-T, one independent forward substitution per row.
+        parallel_for(n - right, nb * nb, [&](size_t begin, size_t end) {
+            for (size_t i = right + begin; i < right + end; ++i) {
+                T* row = a + i * n;
+                for (size_t j = k0; j < right; ++j) {
+                    T sum = row[j];
+                    for (size_t p = k0; p < j; ++p) {
+                        sum -= row[p] * a[j * n + p];
+                    }
+                    row[j] = sum / a[j * n + j];
+                }
+            }
+        });
+
+        // A22 -= L21 L21^T on the lower triangle only, SYRK-style: one GEMM per
+        // block column, from its diagonal block down. The diagonal blocks also
+        // get their upper triangles updated, which are cleared below.
+        size_t rest = n - right;
+        if (rest == 0) {
+            continue;
+        }
+        if constexpr (detail::has_gemm_kernel<T>) {
+            transposed.resize(nb * rest);
+            detail::transpose(rest, nb, a + right * n + k0, n, transposed.data(), rest);
+            for (size_t c0 = right; c0 < n; c0 += block_size) {
+                size_t width = std::min(block_size, n - c0);
+                detail::gemm(n - c0, width, nb, a + c0 * n + k0, n, transposed.data() + (c0 - right), rest,
+                             a + c0 * n + c0, n, true);
+            }
+        } else {
+            parallel_for(rest, rest * nb / 2, [&](size_t begin, size_t end) {
+                for (size_t i = right + begin; i < right + end; ++i) {
+                    for (size_t c = right; c <= i; ++c) {
+                        T sum = T(0);
+                        for (size_t p = k0; p < right; ++p) {
+                            sum += a[i * n + p] * a[c * n + p];
+                        }
+                        a[i * n + c] -= sum;
+                    }
+                }
+            });
+        }
     }
 
-    return transposed;
-}    
+    for (size_t i = 0; i < n; ++i) {
+        std::fill(a + i * n + i + 1, a + (i + 1) * n, T(0));
+    }
+}
+
+template<typename T>
+T cholesky_decomposition<T>::det() const {
+    T res = T(1);
+    for (size_t i = 0; i < m_l.rows(); ++i) {
+        res *= m_l(i, i) * m_l(i, i);
+    }
+    return res;
+}
+
+template<typename T>
+Matrix<T> cholesky_decomposition<T>::solve(const Matrix<T>& b) const {
+    size_t n = m_l.rows();
+    if (b.rows() != n) {
+        throw std::runtime_error("Incompatible sizes");
+    }
+    size_t k = b.columns();
+    Matrix<T> x(b);
+    T* xs = x.begin();
+    parallel_for(k, 2 * n * n, [&](size_t begin, size_t end) {
+        for (size_t i = 0; i < n; ++i) {
+            T* row = xs + i * k;
+            for (size_t p = 0; p < i; ++p) {
+                const T factor = m_l(i, p);
+                const T* other = xs + p * k;
+                for (size_t j = begin; j < end; ++j) {
+                    row[j] -= factor * other[j];
+                }
+            }
+            for (size_t j = begin; j < end; ++j) {
+                row[j] /= m_l(i, i);
+            }
+        }
+        for (size_t i = n; i-- > 0;) {
+            T* row = xs + i * k;
+            for (size_t p = i + 1; p < n; ++p) {
+                const T factor = m_l(p, i);
+                const T* other = xs + p * k;
+                for (size_t j = begin; j < end; ++j) {
+                    row[j] -= factor * other[j];
+                }
+            }
+            for (size_t j = begin; j < end; ++j) {
+                row[j] /= m_l(i, i);
+            }
+        }
+    });
+    return x;
+}
+
+template<typename T>
+Matrix<T> cholesky_decomposition<T>::inverse() const {
+    size_t n = m_l.rows();
+    Matrix<T> identity(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        identity(i, i) = T(1);
+    }
+    return solve(identity);
+}
+
+// X with AX = B for square nonsingular A, via LU with partial pivoting. Pass A
+// as an rvalue to factor it in place; use cholesky_decomposition directly for
+// symmetric positive definite A.
+template<typename T>
+Matrix<T> solve(const Matrix<T>& a, const Matrix<T>& b) {
+    return lu_decomposition<T>(a).solve(b);
+}
+
+template<typename T>
+Matrix<T> solve(Matrix<T>&& a, const Matrix<T>& b) {
+    return lu_decomposition<T>(std::move(a)).solve(b);
+}
 
 template<typename T, typename U> 
 Matrix<std::common_type_t<T, U>> operator+(const Matrix<T>& first, const Matrix<U>& second) { 
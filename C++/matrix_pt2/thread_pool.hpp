@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace linalg {
+
+// Fixed set of workers that split a range of indices between themselves and
+// the calling thread. One range runs at a time; a parallel_for issued from
+// inside a running one executes serially instead of waiting on the pool.
+class thread_pool {
+    public:
+
+    explicit thread_pool(size_t threads);
+
+    thread_pool(const thread_pool&) = delete;
+
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool();
+
+    // Number of threads work is split between, the caller included.
+    size_t size() const noexcept { return m_workers.size() + 1; }
+
+    // Calls func(begin, end) on consecutive chunks of [0, count) of at most
+    // grain indices and returns once all are done. The first exception thrown
+    // by func is rethrown here; the chunks not yet started are skipped.
+    template<typename Func>
+    void parallel_for(size_t count, size_t grain, Func&& func);
+
+    private:
+
+    static bool& inside_pool() {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    void worker_loop();
+
+    void run_chunks();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_submit;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    std::function<void(size_t, size_t)> m_job;
+    size_t m_count = 0;
+    size_t m_grain = 1;
+    std::atomic<size_t> m_next{0};
+    size_t m_active = 0;
+    size_t m_generation = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+};
+
+inline thread_pool::thread_pool(size_t threads) {
+    for (size_t i = 1; i < threads; ++i) {
+        m_workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+inline thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+template<typename Func>
+void thread_pool::parallel_for(size_t count, size_t grain, Func&& func) {
+    grain = std::max<size_t>(grain, 1);
+    if (count <= grain || m_workers.empty() || inside_pool()) {
+        if (count > 0) {
+            func(size_t(0), count);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(m_submit);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = std::ref(func);
+        m_count = count;
+        m_grain = grain;
+        m_next = 0;
+        m_active = m_workers.size();
+        m_error = nullptr;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    inside_pool() = true;
+    run_chunks();
+    inside_pool() = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_active == 0; });
+    m_job = nullptr;
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+inline void thread_pool::worker_loop() {
+    inside_pool() = true;
+    size_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        run_chunks();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_active == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+inline void thread_pool::run_chunks() {
+    while (true) {
+        size_t begin = m_next.fetch_add(m_grain);
+        if (begin >= m_count) {
+            return;
+        }
+        try {
+            m_job(begin, std::min(begin + m_grain, m_count));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+            m_next = m_count;
+        }
+    }
+}
+
+namespace detail {
+
+struct parallel_settings {
+    std::mutex mutex;
+    std::unique_ptr<thread_pool> pool;
+    size_t threads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    size_t cutoff = size_t(1) << 16;
+};
+
+inline parallel_settings& settings() {
+    static parallel_settings instance;
+    return instance;
+}
+
+} // namespace detail
+
+// Threads used by Matrix operations, the caller included; 1 disables threading.
+// Must not be changed while an operation is running.
+inline void set_num_threads(size_t threads) {
+    auto& settings = detail::settings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    settings.threads = std::max<size_t>(threads, 1);
+    settings.pool.reset();
+}
+
+inline size_t num_threads() { return detail::settings().threads; }
+
+// Operations doing fewer than work scalar operations run on the calling thread.
+inline void set_parallel_cutoff(size_t work) { detail::settings().cutoff = work; }
+
+inline size_t parallel_cutoff() { return detail::settings().cutoff; }
+
+inline thread_pool& default_pool() {
+    auto& settings = detail::settings();
+    std::lock_guard<std::mutex> lock(settings.mutex);
+    if (!settings.pool) {
+        settings.pool = std::make_unique<thread_pool>(settings.threads);
+    }
+    return *settings.pool;
+}
+
+// Splits [0, count) over the default pool when count items of work_per_item
+// operations each are worth it, in chunks of at least parallel_cutoff() work.
+template<typename Func>
+void parallel_for(size_t count, size_t work_per_item, Func&& func) {
+    size_t cutoff = parallel_cutoff();
+    work_per_item = std::max<size_t>(work_per_item, 1);
+    if (count == 0) {
+        return;
+    }
+    if (num_threads() <= 1 || count * work_per_item < cutoff) {
+        func(size_t(0), count);
+        return;
+    }
+    size_t grain = std::max(cutoff / work_per_item, count / (num_threads() * 4));
+    default_pool().parallel_for(count, grain, func);
+}
+
+} // namespace linalg
@@ -0,0 +1,106 @@
+#include "intern.hpp"
+
+// The second entry is never read as a header; its zero bytes are the empty
+// string's '\0'. The hash matches StringView("").Hash(), so an empty handle
+// hashes like the text it views.
+const InternedString::Entry InternedString::kEmpty[2] = {{StringView().Hash(), 0}, {}};
+
+std::ostream& operator<<(std::ostream& output, InternedString str) { return output << str.View(); }
+
+InternedString InternPool::Intern(StringView str) {
+  if (str.Empty()) {
+    return InternedString();
+  }
+  size_t hash = str.Hash();
+  // The low bits pick the slot inside a shard, so shard by the high ones.
+  Shard& shard = shards_[(hash >> (sizeof(size_t) * 8 - 4)) % kShardCount];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  const Entry* entry = shard.Find(str, hash);
+  if (entry == nullptr) {
+    entry = shard.Insert(str, hash);
+  }
+  return InternedString(entry);
+}
+
+size_t InternPool::Size() const {
+  size_t res = 0;
+  for (const Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    res += shard.count;
+  }
+  return res;
+}
+
+InternPool& InternPool::Global() {
+  static InternPool* pool = new InternPool();
+  return *pool;
+}
+
+const InternPool::Entry* InternPool::Shard::Find(StringView str, size_t hash) const {
+  if (slots.empty()) {
+    return nullptr;
+  }
+  size_t mask = slots.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    const Entry* entry = slots[i];
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    if (entry->hash == hash && StringView(entry->Data(), entry->size) == str) {
+      return entry;
+    }
+  }
+}
+
+const InternPool::Entry* InternPool::Shard::Insert(StringView str, size_t hash) {
+  if ((count + 1) * 4 > slots.size() * 3) {
+    Grow();
+  }
+  Entry* entry = Allocate(str.Size());
+  entry->hash = hash;
+  entry->size = str.Size();
+  char* data = const_cast<char*>(entry->Data());
+  memcpy(data, str.Data(), str.Size());
+  data[str.Size()] = '\0';
+
+  size_t mask = slots.size() - 1;
+  size_t i = hash & mask;
+  while (slots[i] != nullptr) {
+    i = (i + 1) & mask;
+  }
+  slots[i] = entry;
+  ++count;
+  return entry;
+}
+
+InternPool::Entry* InternPool::Shard::Allocate(size_t size) {
+  size_t bytes = (sizeof(Entry) + size + 1 + alignof(Entry) - 1) & ~(alignof(Entry) - 1);
+  if (bytes > kBlockSize / 4) {
+    blocks.emplace_back(new char[bytes]);
+    return reinterpret_cast<Entry*>(blocks.back().get());
+  }
+  if (bytes > free_size) {
+    blocks.emplace_back(new char[kBlockSize]);
+    free = blocks.back().get();
+    free_size = kBlockSize;
+  }
+  Entry* entry = reinterpret_cast<Entry*>(free);
+  free += bytes;
+  free_size -= bytes;
+  return entry;
+}
+
+void InternPool::Shard::Grow() {
+  std::vector<const Entry*> old = std::move(slots);
+  slots.assign(old.empty() ? 64 : old.size() * 2, nullptr);
+  size_t mask = slots.size() - 1;
+  for (const Entry* entry : old) {
+    if (entry != nullptr) {
+      size_t i = entry->hash & mask;
+      while (slots[i] != nullptr) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = entry;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "string.hpp"
+
+class InternPool;
+
+// Handle to a string stored once in an InternPool. Handles from the same pool
+// are equal iff their texts are, so == is a pointer compare and the hash is
+// computed once at interning time. A handle stays valid while its pool lives;
+// the default handle is the empty string.
+class InternedString {
+ public:
+  InternedString() = default;
+
+  StringView View() const { return StringView(entry_->Data(), entry_->size); }
+
+  const char* Data() const { return entry_->Data(); }
+
+  size_t Size() const { return entry_->size; }
+
+  bool Empty() const { return entry_->size == 0; }
+
+  size_t Hash() const { return entry_->hash; }
+
+  friend bool operator==(InternedString first, InternedString second) {
+    return first.entry_ == second.entry_;
+  }
+
+  friend bool operator!=(InternedString first, InternedString second) {
+    return first.entry_ != second.entry_;
+  }
+
+ private:
+  friend class InternPool;
+
+  // Header of an interned string; the chars (and a '\0') follow it in the arena.
+  struct Entry {
+    size_t hash;
+    size_t size;
+
+    const char* Data() const { return reinterpret_cast<const char*>(this + 1); }
+  };
+
+  static const Entry kEmpty[2];
+
+  explicit InternedString(const Entry* entry) : entry_(entry) {}
+
+  const Entry* entry_ = kEmpty;
+};
+
+template <>
+struct std::hash<InternedString> {
+  size_t operator()(InternedString str) const { return str.Hash(); }
+};
+
+std::ostream& operator<<(std::ostream& output, InternedString str);
+
+// Thread-safe set of interned strings. The table is split into shards picked
+// by hash, each with its own lock, open-addressing table and arena, so
+// threads interning different strings rarely contend. Memory is released only
+// when the pool is destroyed.
+class InternPool {
+ public:
+  InternPool() = default;
+
+  InternPool(const InternPool&) = delete;
+
+  InternPool& operator=(const InternPool&) = delete;
+
+  InternedString Intern(StringView str);
+
+  size_t Size() const;
+
+  // Process-wide pool that is never destroyed.
+  static InternPool& Global();
+
+ private:
+  using Entry = InternedString::Entry;
+
+  static const size_t kShardCount = 16;
+
+  static const size_t kBlockSize = 64 * 1024;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::vector<const Entry*> slots;
+    size_t count = 0;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* free = nullptr;
+    size_t free_size = 0;
+
+    const Entry* Find(StringView str, size_t hash) const;
+
+    const Entry* Insert(StringView str, size_t hash);
+
+    Entry* Allocate(size_t size);
+
+    void Grow();
+  };
+
+  Shard shards_[kShardCount];
+};
+
+inline InternedString Intern(StringView str) { return InternPool::Global().Intern(str); }
\ No newline at end of file
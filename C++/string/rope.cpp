@@ -0,0 +1,139 @@
+#include "rope.hpp"
+
+namespace {
+
+uint64_t Random() {
+  thread_local uint64_t state = 0x9e3779b97f4a7c15ULL;
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+}  // namespace
+
+Rope::Rope(const char* str) : Rope(StringView(str)) {}
+
+Rope::Rope(StringView text) {
+  if (text.Empty()) {
+    return;
+  }
+  Node leaf;
+  leaf.text = std::make_shared<const String>(text);
+  leaf.length = text.Size();
+  root_ = Make(leaf, nullptr, nullptr);
+}
+
+size_t Rope::Size() const { return SizeOf(root_); }
+
+char Rope::operator[](size_t index) const {
+  const Node* node = root_.get();
+  while (true) {
+    size_t left_size = SizeOf(node->left);
+    if (index < left_size) {
+      node = node->left.get();
+    } else if (index < left_size + node->length) {
+      return (*node->text)[node->offset + index - left_size];
+    } else {
+      index -= left_size + node->length;
+      node = node->right.get();
+    }
+  }
+}
+
+void Rope::Insert(size_t pos, const Rope& other) {
+  auto [left, right] = Split(root_, pos);
+  root_ = Merge(Merge(left, other.root_), right);
+}
+
+void Rope::Insert(size_t pos, StringView text) { Insert(pos, Rope(text)); }
+
+void Rope::Erase(size_t pos, size_t count) {
+  auto [left, rest] = Split(root_, pos);
+  auto [erased, right] = Split(rest, count);
+  root_ = Merge(left, right);
+}
+
+Rope Rope::Substr(size_t pos, size_t count) const {
+  auto [left, rest] = Split(root_, pos);
+  auto [middle, right] = Split(rest, count);
+  return Rope(middle);
+}
+
+Rope& Rope::operator+=(const Rope& other) {
+  root_ = Merge(root_, other.root_);
+  return *this;
+}
+
+String Rope::ToString() const {
+  String res;
+  res.Reserve(Size());
+  ForEachChunk([&res](StringView chunk) { res.Append(chunk.Data(), chunk.Size()); });
+  return res;
+}
+
+size_t Rope::SizeOf(const NodePtr& node) { return node == nullptr ? 0 : node->size; }
+
+size_t Rope::NodesOf(const NodePtr& node) { return node == nullptr ? 0 : node->nodes; }
+
+Rope::NodePtr Rope::Make(const Node& proto, NodePtr left, NodePtr right) {
+  auto node = std::make_shared<Node>(proto);
+  node->size = SizeOf(left) + node->length + SizeOf(right);
+  node->nodes = NodesOf(left) + 1 + NodesOf(right);
+  node->left = std::move(left);
+  node->right = std::move(right);
+  return node;
+}
+
+std::pair<Rope::NodePtr, Rope::NodePtr> Rope::Split(const NodePtr& node, size_t pos) {
+  if (node == nullptr) {
+    return {nullptr, nullptr};
+  }
+  if (pos == 0) {
+    return {nullptr, node};
+  }
+  if (pos >= node->size) {
+    return {node, nullptr};
+  }
+
+  size_t left_size = SizeOf(node->left);
+  if (pos <= left_size) {
+    auto [first, second] = Split(node->left, pos);
+    return {first, Make(*node, second, node->right)};
+  }
+  if (pos >= left_size + node->length) {
+    auto [first, second] = Split(node->right, pos - left_size - node->length);
+    return {Make(*node, node->left, first), second};
+  }
+
+  // pos falls inside this chunk: both halves keep the text.
+  size_t cut = pos - left_size;
+  Node head = *node;
+  head.length = cut;
+  Node tail = *node;
+  tail.offset += cut;
+  tail.length -= cut;
+  return {Make(head, node->left, nullptr), Make(tail, nullptr, node->right)};
+}
+
+Rope::NodePtr Rope::Merge(const NodePtr& first, const NodePtr& second) {
+  if (first == nullptr) {
+    return second;
+  }
+  if (second == nullptr) {
+    return first;
+  }
+  // The root of a random treap over both sequences is in first with
+  // probability proportional to its share of the nodes.
+  size_t first_nodes = first->nodes;
+  if (Random() % (first_nodes + second->nodes) < first_nodes) {
+    return Make(*first, first->left, Merge(first->right, second));
+  }
+  return Make(*second, Merge(first, second->left), second->right);
+}
+
+Rope operator+(const Rope& first, const Rope& second) {
+  Rope res = first;
+  res += second;
+  return res;
+}
\ No newline at end of file
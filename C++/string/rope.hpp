@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "string.hpp"
+
+// Immutable-node string for large texts. Chunks of text sit in the nodes of
+// an implicit treap, ordered by position. Insert, Erase and Substr split and
+// merge along one path in O(log n) expected time and copy only that path, so
+// copying a Rope is a cheap snapshot that shares everything else. A chunk is a
+// range of a shared String, so splitting a chunk does not copy text either.
+// Merge picks each root at random, weighted by node count, rather than by
+// stored priorities: a subtree shared twice in one tree, as in r += r, would
+// carry equal priorities on both sides and degenerate into a chain.
+class Rope {
+ public:
+  Rope() = default;
+
+  Rope(const char* str);
+
+  explicit Rope(StringView text);
+
+  size_t Size() const;
+
+  bool Empty() const { return Size() == 0; }
+
+  char operator[](size_t index) const;
+
+  void Insert(size_t pos, const Rope& other);
+
+  void Insert(size_t pos, StringView text);
+
+  void Insert(size_t pos, const char* text) { Insert(pos, StringView(text)); }
+
+  void Erase(size_t pos, size_t count);
+
+  Rope Substr(size_t pos, size_t count) const;
+
+  Rope& operator+=(const Rope& other);
+
+  String ToString() const;
+
+  // Calls func(StringView) for every contiguous chunk, in order.
+  template <typename Func>
+  void ForEachChunk(Func func) const {
+    ForEachChunk(root_.get(), func);
+  }
+
+ private:
+  struct Node;
+
+  using NodePtr = std::shared_ptr<const Node>;
+
+  explicit Rope(NodePtr root) : root_(std::move(root)) {}
+
+  static size_t SizeOf(const NodePtr& node);
+
+  static size_t NodesOf(const NodePtr& node);
+
+  static NodePtr Make(const Node& proto, NodePtr left, NodePtr right);
+
+  static std::pair<NodePtr, NodePtr> Split(const NodePtr& node, size_t pos);
+
+  static NodePtr Merge(const NodePtr& first, const NodePtr& second);
+
+  template <typename Func>
+  static void ForEachChunk(const Node* node, Func& func);
+
+  NodePtr root_;
+};
+
+struct Rope::Node {
+  std::shared_ptr<const String> text;
+  size_t offset = 0;
+  size_t length = 0;
+  NodePtr left;
+  NodePtr right;
+  size_t size = 0;
+  size_t nodes = 0;
+};
+
+template <typename Func>
+void Rope::ForEachChunk(const Node* node, Func& func) {
+  if (node == nullptr) {
+    return;
+  }
+  ForEachChunk(node->left.get(), func);
+  func(StringView(node->text->Data() + node->offset, node->length));
+  ForEachChunk(node->right.get(), func);
+}
+
+Rope operator+(const Rope& first, const Rope& second);
\ No newline at end of file
@@ -0,0 +1,74 @@
+// Regression checks for Rope on trees that share subtrees with themselves.
+//
+//   g++ -std=c++20 -O2 rope_test.cpp rope.cpp string.cpp
+//   ./a.out
+
+#include "rope.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+std::string ToStd(const Rope& rope) {
+  std::string res;
+  rope.ForEachChunk([&res](StringView chunk) { res.append(chunk.Data(), chunk.Size()); });
+  return res;
+}
+
+// r += r shares the whole tree twice. Forty doublings are 2^40 chunks, far
+// deeper than the stack if the shared halves stacked into a chain.
+void SelfAppend() {
+  std::string expected = "abcdefgh";
+  Rope rope("abcdefgh");
+  for (int i = 0; i < 12; ++i) {
+    rope += rope;
+    expected += expected;
+  }
+  assert(ToStd(rope) == expected);
+
+  for (int i = 12; i < 40; ++i) {
+    rope += rope;
+  }
+  assert(rope.Size() == (size_t{8} << 40));
+  for (size_t pos = 0; pos < rope.Size(); pos = pos * 3 + 7) {
+    assert(rope[pos] == "abcdefgh"[pos % 8]);
+  }
+  rope.Erase(3, rope.Size() - 6);
+  assert(ToStd(rope) == "abcfgh");
+}
+
+// Substrings of a rope inserted back into it, over and over.
+void SelfInsert() {
+  std::string expected = "0123456789";
+  Rope rope("0123456789");
+  for (int i = 0; i < 20000; ++i) {
+    size_t size = expected.size();
+    size_t pos = (i * 7919ULL) % (size + 1);
+    size_t from = (i * 104729ULL) % size;
+    size_t count = 1 + (i * 31ULL) % (i % 2 == 0 ? 16 : 4);
+    if (i % 2 == 0) {
+      rope.Insert(pos, rope.Substr(from, count));
+      expected.insert(pos, expected.substr(from, count));
+    } else {
+      rope.Erase(pos % size, count);
+      expected.erase(pos % size, count);
+    }
+  }
+  assert(ToStd(rope) == expected);
+
+  for (int i = 0; i < 40; ++i) {
+    rope.Insert(rope.Size() / 2, rope);
+  }
+  assert(rope.Size() == expected.size() << 40);
+  assert(rope[rope.Size() - 1] == expected.back());
+}
+
+}  // namespace
+
+int main() {
+  SelfAppend();
+  SelfInsert();
+  printf("ok\n");
+}
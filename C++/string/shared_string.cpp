@@ -0,0 +1,88 @@
+#include "shared_string.hpp"
+
+#include <algorithm>
+
+SharedString::SharedString(StringView view) : size_(view.Size()) {
+  if (view.Empty()) {
+    return;
+  }
+  char* data = new char[size_ + 1];
+  memcpy(data, view.Data(), size_);
+  data[size_] = '\0';
+  buffer_ = new Buffer{{1}, data};
+  data_ = data;
+}
+
+SharedString::SharedString(String&& str) : size_(str.Size()) {
+  if (str.Empty()) {
+    return;
+  }
+  char* data = str.ReleaseBuffer();
+  if (data == nullptr) {
+    // Short strings live inside the String object, so their few chars are copied.
+    *this = SharedString(StringView(str));
+    str.Clear();
+    return;
+  }
+  buffer_ = new Buffer{{1}, data};
+  data_ = data;
+}
+
+SharedString::SharedString(Buffer* buffer, const char* data, size_t size)
+    : buffer_(buffer), data_(data), size_(size) {
+  Acquire();
+}
+
+SharedString::SharedString(const SharedString& other)
+    : buffer_(other.buffer_), data_(other.data_), size_(other.size_) {
+  Acquire();
+}
+
+SharedString::SharedString(SharedString&& other) noexcept { Swap(other); }
+
+SharedString& SharedString::operator=(const SharedString& other) {
+  SharedString copy(other);
+  Swap(copy);
+  return *this;
+}
+
+SharedString& SharedString::operator=(SharedString&& other) noexcept {
+  SharedString moved(std::move(other));
+  Swap(moved);
+  return *this;
+}
+
+SharedString::~SharedString() { ReleaseRef(); }
+
+SharedString SharedString::Substr(size_t pos, size_t count) const {
+  pos = std::min(pos, size_);
+  count = std::min(count, size_ - pos);
+  if (count == 0) {
+    return SharedString();
+  }
+  return SharedString(buffer_, data_ + pos, count);
+}
+
+size_t SharedString::UseCount() const {
+  return buffer_ == nullptr ? 0 : buffer_->refs.load(std::memory_order_relaxed);
+}
+
+void SharedString::Swap(SharedString& other) {
+  std::swap(buffer_, other.buffer_);
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+}
+
+void SharedString::Acquire() const {
+  if (buffer_ != nullptr) {
+    buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void SharedString::ReleaseRef() {
+  if (buffer_ != nullptr && buffer_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete[] buffer_->data;
+    delete buffer_;
+  }
+  buffer_ = nullptr;
+}
\ No newline at end of file
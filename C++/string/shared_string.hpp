@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+
+#include "string.hpp"
+
+// Immutable string whose buffer is shared by all its copies and substrings
+// and freed with the last of them. Copying and Substr are O(1): they bump an
+// atomic reference count. A String moved in is frozen without copying its
+// buffer. Data() of a substring is not null-terminated.
+class SharedString {
+ public:
+  SharedString() = default;
+
+  explicit SharedString(StringView view);
+
+  explicit SharedString(String&& str);
+
+  SharedString(const SharedString& other);
+
+  SharedString(SharedString&& other) noexcept;
+
+  SharedString& operator=(const SharedString& other);
+
+  SharedString& operator=(SharedString&& other) noexcept;
+
+  ~SharedString();
+
+  const char& operator[](size_t index) const { return data_[index]; }
+
+  size_t Size() const { return size_; }
+
+  bool Empty() const { return size_ == 0; }
+
+  const char* Data() const { return data_; }
+
+  StringView View() const { return StringView(data_, size_); }
+
+  operator StringView() const { return View(); }
+
+  SharedString Substr(size_t pos, size_t count = StringView::kNpos) const;
+
+  String ToString() const { return String(View()); }
+
+  // Number of SharedStrings sharing the buffer; 0 for an empty default one.
+  size_t UseCount() const;
+
+  void Swap(SharedString& other);
+
+ private:
+  struct Buffer {
+    std::atomic<size_t> refs;
+    char* data;
+  };
+
+  SharedString(Buffer* buffer, const char* data, size_t size);
+
+  void Acquire() const;
+
+  void ReleaseRef();
+
+  Buffer* buffer_ = nullptr;
+  const char* data_ = "";
+  size_t size_ = 0;
+};
+
+template <>
+struct std::hash<SharedString> {
+  size_t operator()(const SharedString& str) const { return str.View().Hash(); }
+};
\ No newline at end of file
@@ -1,222 +1,448 @@
 #include "string.hpp"
 
-String::String(size_t size, char character)
-    : size_(size), ptr_(new char[size + 1]), capacity_(size) {
-  for (size_t count = 0; count < size; ++count) {
-    ptr_[count] = character;
+#include <cstdint>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Candidate positions are those where both the first and the last char of the
+// needle match, checked 16 at a time. Only they are compared in full.
+size_t FindBytes(const char* hay, size_t hay_size, const char* needle, size_t needle_size,
+                 size_t pos) {
+  if (needle_size == 0) {
+    return pos <= hay_size ? pos : String::kNpos;
+  }
+  if (pos > hay_size || hay_size - pos < needle_size) {
+    return String::kNpos;
+  }
+  if (needle_size == 1) {
+    const void* found = memchr(hay + pos, needle[0], hay_size - pos);
+    return found == nullptr ? String::kNpos : static_cast<const char*>(found) - hay;
+  }
+
+  size_t last = needle_size - 1;
+  size_t end = hay_size - needle_size + 1;
+  size_t cur = pos;
+#ifdef __SSE2__
+  const __m128i first_char = _mm_set1_epi8(needle[0]);
+  const __m128i last_char = _mm_set1_epi8(needle[last]);
+  for (; cur + 16 <= end; cur += 16) {
+    __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + cur));
+    __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + cur + last));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first_char),
+                                                    _mm_cmpeq_epi8(block_last, last_char)));
+    while (mask != 0) {
+      unsigned bit = __builtin_ctz(mask);
+      if (memcmp(hay + cur + bit + 1, needle + 1, needle_size - 2) == 0) {
+        return cur + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; cur < end; ++cur) {
+    if (hay[cur] == needle[0] && hay[cur + last] == needle[last] &&
+        memcmp(hay + cur + 1, needle + 1, needle_size - 2) == 0) {
+      return cur;
+    }
   }
-  ptr_[size] = '\0';
+  return String::kNpos;
 }
 
-String::String(const char* ptr_input)
-    : size_(strlen(ptr_input)), ptr_(new char[size_ + 1]), capacity_(size_) {
-  std::copy(ptr_input, ptr_input + size_, ptr_);
-  ptr_[size_] = '\0';
+size_t RFindBytes(const char* hay, size_t hay_size, const char* needle, size_t needle_size,
+                  size_t pos) {
+  if (hay_size < needle_size) {
+    return String::kNpos;
+  }
+  size_t start = std::min(pos, hay_size - needle_size);
+  if (needle_size == 0) {
+    return start;
+  }
+
+  size_t last = needle_size - 1;
+  // cur is one past the next candidate to check.
+  size_t cur = start + 1;
+#ifdef __SSE2__
+  const __m128i first_char = _mm_set1_epi8(needle[0]);
+  const __m128i last_char = _mm_set1_epi8(needle[last]);
+  for (; cur >= 16; cur -= 16) {
+    size_t base = cur - 16;
+    __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + base));
+    __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + base + last));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first_char),
+                                                    _mm_cmpeq_epi8(block_last, last_char)));
+    while (mask != 0) {
+      unsigned bit = 31 - __builtin_clz(mask);
+      if (memcmp(hay + base + bit, needle, needle_size) == 0) {
+        return base + bit;
+      }
+      mask &= ~(1u << bit);
+    }
+  }
+#endif
+  while (cur > 0) {
+    --cur;
+    if (hay[cur] == needle[0] && memcmp(hay + cur, needle, needle_size) == 0) {
+      return cur;
+    }
+  }
+  return String::kNpos;
 }
 
-String::String(const String& other) : String(other.Data()) {}
+// wyhash (final version 4): a 64x64->128 multiply mixes 16 bytes per step, so
+// short keys take a handful of instructions and long ones run near memory speed.
+const uint64_t kWySecret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                               0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+void WyMum(uint64_t& first, uint64_t& second) {
+  __uint128_t product = static_cast<__uint128_t>(first) * second;
+  first = static_cast<uint64_t>(product);
+  second = static_cast<uint64_t>(product >> 64);
+}
+
+uint64_t WyMix(uint64_t first, uint64_t second) {
+  WyMum(first, second);
+  return first ^ second;
+}
+
+uint64_t WyRead8(const unsigned char* data) {
+  uint64_t res;
+  memcpy(&res, data, sizeof(res));
+  return res;
+}
+
+uint64_t WyRead4(const unsigned char* data) {
+  uint32_t res;
+  memcpy(&res, data, sizeof(res));
+  return res;
+}
+
+uint64_t WyHash(const char* key, size_t size) {
+  const auto* data = reinterpret_cast<const unsigned char*>(key);
+  uint64_t seed = WyMix(kWySecret[0], kWySecret[1]);
+  uint64_t first;
+  uint64_t second;
+  if (size <= 16) {
+    if (size >= 4) {
+      size_t shift = (size >> 3) << 2;
+      first = (WyRead4(data) << 32) | WyRead4(data + shift);
+      second = (WyRead4(data + size - 4) << 32) | WyRead4(data + size - 4 - shift);
+    } else if (size > 0) {
+      first = (static_cast<uint64_t>(data[0]) << 16) | (static_cast<uint64_t>(data[size >> 1]) << 8) |
+              data[size - 1];
+      second = 0;
+    } else {
+      first = second = 0;
+    }
+  } else {
+    size_t rest = size;
+    if (rest > 48) {
+      uint64_t seed1 = seed;
+      uint64_t seed2 = seed;
+      do {
+        seed = WyMix(WyRead8(data) ^ kWySecret[1], WyRead8(data + 8) ^ seed);
+        seed1 = WyMix(WyRead8(data + 16) ^ kWySecret[2], WyRead8(data + 24) ^ seed1);
+        seed2 = WyMix(WyRead8(data + 32) ^ kWySecret[3], WyRead8(data + 40) ^ seed2);
+        data += 48;
+        rest -= 48;
+      } while (rest > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (rest > 16) {
+      seed = WyMix(WyRead8(data) ^ kWySecret[1], WyRead8(data + 8) ^ seed);
+      data += 16;
+      rest -= 16;
+    }
+    first = WyRead8(data + rest - 16);
+    second = WyRead8(data + rest - 8);
+  }
+  first ^= kWySecret[1];
+  second ^= seed;
+  WyMum(first, second);
+  return WyMix(first ^ kWySecret[0] ^ size, second ^ kWySecret[1]);
+}
+
+}  // namespace
+
+String::String(size_t size, char character) {
+  Reserve(size);
+  memset(Ptr(), character, size);
+  SetSize(size);
+}
+
+String::String(const char* ptr_input) {
+  size_t size = strlen(ptr_input);
+  Reserve(size);
+  std::copy(ptr_input, ptr_input + size, Ptr());
+  SetSize(size);
+}
+
+String::String(StringView view) {
+  Reserve(view.Size());
+  std::memcpy(Ptr(), view.Data(), view.Size());
+  SetSize(view.Size());
+}
+
+String::String(const String& other) {
+  Reserve(other.Size());
+  std::memcpy(Ptr(), other.Data(), other.Size());
+  SetSize(other.Size());
+}
+
+String::String(String&& other) noexcept : long_(other.long_) {
+  std::fill(other.short_, other.short_ + sizeof(LongRep), '\0');
+}
 
 String& String::operator=(const String& other) {
   if (&other == this) {
     return *this;
   }
-  if (capacity_ >= other.size_) {
-    size_ = other.size_;
-    std::copy(other.ptr_, other.ptr_ + size_, ptr_);
-    ptr_[size_] = '\0';
-    return *this;
+  if (Capacity() < other.Size()) {
+    SetSize(0);
+    NewCapacity(other.Capacity());
   }
-  delete[] ptr_;
-  size_ = other.size_;
-  capacity_ = other.capacity_;
-  ptr_ = new char[capacity_ + 1];
-  std::copy(other.ptr_, other.ptr_ + size_, ptr_);
-  ptr_[size_] = '\0';
+  std::memcpy(Ptr(), other.Data(), other.Size());
+  SetSize(other.Size());
   return *this;
 }
 
-String::~String() { delete[] ptr_; }
+String& String::operator=(String&& other) noexcept {
+  if (&other == this) {
+    return *this;
+  }
+  if (IsLong()) {
+    delete[] long_.ptr;
+  }
+  long_ = other.long_;
+  std::fill(other.short_, other.short_ + sizeof(LongRep), '\0');
+  return *this;
+}
 
-void String::Clear() {
-  ptr_[0] = '\0';
-  size_ = 0;
+String::~String() {
+  if (IsLong()) {
+    delete[] long_.ptr;
+  }
 }
 
+void String::Clear() { SetSize(0); }
+
 void String::PushBack(char character) {
-  if (capacity_ == 0) {
-    Reserve(1);
-  } else {
-    if (size_ == capacity_) {
-      Reserve(capacity_ * 2);
-    }
+  size_t size = Size();
+  if (size == Capacity()) {
+    Reserve(Capacity() * 2);
   }
-  ptr_[size_] = character;
-  ++size_;
-  ptr_[size_] = '\0';
+  Ptr()[size] = character;
+  SetSize(size + 1);
 }
 
 void String::PopBack() {
-  if (size_ == 0) {
+  if (Empty()) {
     return;
   }
-  ptr_[size_ - 1] = '\0';
-  --size_;
+  SetSize(Size() - 1);
 }
 
 void String::Resize(size_t new_size) {
-  if (new_size > capacity_) {
-    char* new_ptr = new char[new_size + 1];
-    std::copy(ptr_, ptr_ + size_, new_ptr);
-    delete[] ptr_;
-    ptr_ = new_ptr;
-    capacity_ = new_size;
-    size_ = new_size;
-    return;
-  }
-  size_ = new_size;
+  Reserve(new_size);
+  SetSize(new_size);
 }
 
 void String::Resize(size_t new_size, char character) {
   Reserve(new_size);
-  for (size_t count = size_; count < new_size; ++count) {
-    ptr_[count] = character;
+  size_t size = Size();
+  if (new_size > size) {
+    memset(Ptr() + size, character, new_size - size);
   }
-  ptr_[new_size] = '\0';
-  size_ = new_size;
+  SetSize(new_size);
 }
 
 void String::Reserve(size_t new_cap) {
-  if (new_cap > capacity_) {
+  if (new_cap > Capacity()) {
     NewCapacity(new_cap);
   }
 }
 
 void String::ShrinkToFit() {
-  if (capacity_ > size_) {
-    NewCapacity(size_);
+  if (IsLong() && Capacity() > Size()) {
+    NewCapacity(Size());
+  }
+}
+
+void String::SetSize(size_t new_size) {
+  if (IsLong()) {
+    long_.size = new_size;
+    long_.ptr[new_size] = '\0';
+    return;
+  }
+  short_[new_size] = '\0';
+  short_[sizeof(LongRep) - 1] = static_cast<char>(new_size);
+}
+
+char* String::ReleaseBuffer() {
+  if (!IsLong()) {
+    return nullptr;
   }
+  char* ptr = long_.ptr;
+  std::fill(short_, short_ + sizeof(LongRep), '\0');
+  return ptr;
 }
 
 void String::NewCapacity(size_t new_cap) {
+  size_t size = Size();
+  if (new_cap <= kShortCapacity) {
+    if (IsLong()) {
+      char* old_ptr = long_.ptr;
+      std::copy(old_ptr, old_ptr + size, short_);
+      delete[] old_ptr;
+      short_[sizeof(LongRep) - 1] = 0;
+      SetSize(size);
+    }
+    return;
+  }
+
   char* ptr_new = new char[new_cap + 1];
-  std::copy(ptr_, ptr_ + size_, ptr_new);
-  delete[] ptr_;
-  capacity_ = new_cap;
-  ptr_ = ptr_new;
+  std::copy(Ptr(), Ptr() + size, ptr_new);
+  ptr_new[size] = '\0';
+  if (IsLong()) {
+    delete[] long_.ptr;
+  }
+  long_.ptr = ptr_new;
+  long_.size = size;
+  long_.capacity = (kLittleEndian ? new_cap : new_cap << 8) | kLongFlag;
 }
 
-void String::Swap(String& other) {
-  std::swap(ptr_, other.ptr_);
-  std::swap(size_, other.size_);
-  std::swap(capacity_, other.capacity_);
-}
+void String::Swap(String& other) { std::swap(short_, other.short_); }
 
-char& String::operator[](size_t index) { return ptr_[index]; }
+char& String::operator[](size_t index) { return Ptr()[index]; }
 
-const char& String::operator[](size_t index) const { return ptr_[index]; }
+const char& String::operator[](size_t index) const { return Ptr()[index]; }
 
-char& String::Front() { return ptr_[0]; }
+char& String::Front() { return Ptr()[0]; }
 
-const char& String::Front() const { return ptr_[0]; }
+const char& String::Front() const { return Ptr()[0]; }
 
-char& String::Back() { return ptr_[size_ - 1]; }
+char& String::Back() { return Ptr()[Size() - 1]; }
 
-const char& String::Back() const { return ptr_[size_ - 1]; }
+const char& String::Back() const { return Ptr()[Size() - 1]; }
 
-bool String::Empty() const { return (size_ == 0); }
+bool String::Empty() const { return (Size() == 0); }
 
-size_t String::Size() const { return size_; }
+size_t String::Size() const {
+  return IsLong() ? long_.size
+                  : static_cast<unsigned char>(short_[sizeof(LongRep) - 1]);
+}
 
-size_t String::Capacity() const { return capacity_; }
+size_t String::Capacity() const {
+  if (!IsLong()) {
+    return kShortCapacity;
+  }
+  size_t capacity = long_.capacity & ~kLongFlag;
+  return kLittleEndian ? capacity : capacity >> 8;
+}
 
-const char* String::Data() const { return ptr_; }
+const char* String::Data() const { return Ptr(); }
 
-char* String::Data() { return ptr_; }
+char* String::Data() { return Ptr(); }
 
 String& String::operator+=(const String& other) {
-  for (size_t count = 0; count < other.Size(); ++count) {
-    this->PushBack(other[count]);
+  return Append(other.Data(), other.Size());
+}
+
+String& String::Append(const char* data, size_t size) {
+  size_t old_size = Size();
+  if (old_size + size > Capacity()) {
+    // data may point into this string, keep its offset across reallocation.
+    // std::less orders unrelated pointers too, where < and - are undefined.
+    const char* old_ptr = Ptr();
+    std::less<const char*> less;
+    bool inside = !less(data, old_ptr) && less(data, old_ptr + old_size);
+    size_t offset = inside ? data - old_ptr : 0;
+    NewCapacity(std::max(old_size + size, Capacity() * 2));
+    if (inside) {
+      data = Ptr() + offset;
+    }
   }
+  std::memmove(Ptr() + old_size, data, size);
+  SetSize(old_size + size);
   return *this;
 }
 
 String& String::operator*=(size_t num) {
   if (num == 0) {
-    this->Clear();
-  } else {
-    String temp_str(*this);
-    this->Reserve(num * this->Size());
-    for (; num > 1; --num) {
-      *this += temp_str;
-    }
+    Clear();
+    return *this;
+  }
+  size_t size = Size();
+  size_t total = num * size;
+  Reserve(total);
+  // Copy the already repeated prefix onto its end, doubling it each time:
+  // O(log num) memcpy calls, each a straight bandwidth-bound copy.
+  char* ptr = Ptr();
+  for (size_t done = size; done < total;) {
+    size_t chunk = std::min(done, total - done);
+    memcpy(ptr + done, ptr, chunk);
+    done += chunk;
   }
+  SetSize(total);
   return *this;
 }
 
+size_t String::Find(StringView needle, size_t pos) const {
+  return FindBytes(Data(), Size(), needle.Data(), needle.Size(), pos);
+}
+
+size_t String::RFind(StringView needle, size_t pos) const {
+  return RFindBytes(Data(), Size(), needle.Data(), needle.Size(), pos);
+}
+
+bool String::Contains(StringView needle) const { return Find(needle) != kNpos; }
+
+SplitRange String::Tokenize(StringView delim) const { return SplitRange(*this, delim); }
+
 std::vector<String> String::Split(const String& delim) {
   std::vector<String> arr;
-  if (size_ < delim.Size()) {
+  if (delim.Empty()) {
     arr.push_back(*this);
     return arr;
   }
-  bool flag = true;
-  String str_for_arr = "";
-  for (size_t count = 0; count < size_ - delim.Size() + 1; ++count) {
-    flag = true;
-    for (size_t ind = count; ind < delim.Size() + count; ++ind) {
-      flag = (ptr_[ind] == delim[ind - count]);
-      if (!flag) {
-        str_for_arr.PushBack(ptr_[count]);
-        break;
-      }
-    }
-    if (flag) {
-      arr.push_back(str_for_arr);
-      str_for_arr.Clear();
-      count += delim.Size() - 1;
-    }
-  }
-  if (!flag) {
-    for (size_t count = size_ - delim.Size() + 1; count < size_; ++count) {
-      str_for_arr.PushBack(ptr_[count]);
-    }
+  size_t start = 0;
+  for (size_t found = Find(delim); found != kNpos; found = Find(delim, start)) {
+    arr.emplace_back().Append(Data() + start, found - start);
+    start = found + delim.Size();
   }
-  arr.push_back(str_for_arr);
+  arr.emplace_back().Append(Data() + start, Size() - start);
   return arr;
 }
 
 String String::Join(const std::vector<String>& strings) const {
-  String res = "";
+  String res;
   if (strings.empty()) {
     return res;
   }
+  size_t total = Size() * (strings.size() - 1);
+  for (const auto& str : strings) {
+    total += str.Size();
+  }
+  res.Reserve(total);
   for (size_t count = 0; count < strings.size() - 1; ++count) {
-    res = strings[count] + *this;
+    res += strings[count];
+    res += *this;
   }
-  res += *(strings.end() - 1);
+  res += strings.back();
   return res;
 }
 
 bool operator<(const String& first, const String& second) {
-  for (size_t count = 0; count < std::min(first.Size(), second.Size());
-       ++count) {
-    if (first[count] != second[count]) {
-      return (first[count] < second[count]);
-    }
-  }
-  return (first.Size() < second.Size());
+  int cmp = memcmp(first.Data(), second.Data(), std::min(first.Size(), second.Size()));
+  return cmp != 0 ? cmp < 0 : first.Size() < second.Size();
 }
 
 bool operator==(const String& first, const String& second) {
-  if (first.Size() != second.Size()) {
-    return false;
-  }
-  for (size_t count = 0; count < first.Size(); ++count) {
-    if (first[count] != second[count]) {
-      return false;
-    }
-  }
-  return true;
+  return first.Size() == second.Size() &&
+         memcmp(first.Data(), second.Data(), first.Size()) == 0;
 }
 
 bool operator!=(const String& first, const String& second) {
@@ -237,35 +463,171 @@ bool operator>=(const String& first, const String& second) {
 
 String operator+(const String& first, const String& second) {
   String new_string;
+  new_string.Reserve(first.Size() + second.Size());
   new_string += first;
   new_string += second;
   return new_string;
 }
 
+String operator+(String&& first, const String& second) {
+  first += second;
+  return std::move(first);
+}
+
 String operator*(const String& str, size_t num) {
-  String new_str(str);
+  String new_str;
+  new_str.Reserve(str.Size() * num);
+  new_str += str;
   new_str *= num;
   return new_str;
 }
 
 std::ostream& operator<<(std::ostream& out, const String& str) {
-  for (size_t count = 0; count < str.Size(); ++count) {
-    out << str[count];
-  }
-  return out;
+  return out.write(str.Data(), str.Size());
 }
 
 std::istream& operator>>(std::istream& input, String& str) {
-  char buffer;
-  input.get(buffer);
-  while (buffer == ' ') {
-    input.get(buffer);
-  }
-  while ((buffer != ' ') && (buffer != '\n')) {
-    str.PushBack(buffer);
-    if (!input.get(buffer)) {
+  // Length of the last word read on this thread: a fresh String reserves it
+  // up front instead of doubling its way there.
+  thread_local size_t size_hint = 0;
+
+  str.Clear();
+  std::istream::sentry sentry(input);
+  if (!sentry) {
+    return input;
+  }
+  str.Reserve(size_hint);
+
+  std::streamsize width = input.width();
+  size_t limit = width > 0 ? static_cast<size_t>(width) : String::kNpos;
+  input.width(0);
+
+  std::streambuf* buf = input.rdbuf();
+  const auto& ctype = std::use_facet<std::ctype<char>>(input.getloc());
+  char chunk[256];
+  size_t chunk_size = 0;
+  size_t total = 0;
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  for (int sym = buf->sgetc(); total < limit; sym = buf->snextc()) {
+    if (sym == std::char_traits<char>::eof()) {
+      state |= std::ios_base::eofbit;
       break;
     }
+    char ch = std::char_traits<char>::to_char_type(sym);
+    if (ctype.is(std::ctype_base::space, ch)) {
+      break;
+    }
+    chunk[chunk_size++] = ch;
+    ++total;
+    if (chunk_size == sizeof(chunk)) {
+      str.Append(chunk, chunk_size);
+      chunk_size = 0;
+    }
   }
+  str.Append(chunk, chunk_size);
+
+  if (total == 0) {
+    state |= std::ios_base::failbit;
+  }
+  size_hint = total;
+  input.setstate(state);
   return input;
+}
+
+String StrCat(std::initializer_list<StrCatPiece> pieces) {
+  size_t total = 0;
+  for (const auto& piece : pieces) {
+    total += piece.size;
+  }
+  String res;
+  res.Reserve(total);
+  for (const auto& piece : pieces) {
+    res.Append(piece.data, piece.size);
+  }
+  return res;
+}
+
+StringView::StringView(const String& str) : data_(str.Data()), size_(str.Size()) {}
+
+void StringView::RemovePrefix(size_t count) {
+  data_ += count;
+  size_ -= count;
+}
+
+void StringView::RemoveSuffix(size_t count) { size_ -= count; }
+
+StringView StringView::Substr(size_t pos, size_t count) const {
+  pos = std::min(pos, size_);
+  return StringView(data_ + pos, std::min(count, size_ - pos));
+}
+
+size_t StringView::Find(StringView needle, size_t pos) const {
+  return FindBytes(data_, size_, needle.data_, needle.size_, pos);
+}
+
+size_t StringView::RFind(StringView needle, size_t pos) const {
+  return RFindBytes(data_, size_, needle.data_, needle.size_, pos);
+}
+
+bool StringView::Contains(StringView needle) const { return Find(needle) != kNpos; }
+
+std::vector<StringView> StringView::Split(StringView delim) const {
+  std::vector<StringView> arr;
+  for (StringView piece : Tokenize(delim)) {
+    arr.push_back(piece);
+  }
+  return arr;
+}
+
+SplitRange StringView::Tokenize(StringView delim) const { return SplitRange(*this, delim); }
+
+size_t StringView::Hash() const { return WyHash(data_, size_); }
+
+SplitRange::Iterator::Iterator(StringView rest, StringView delim)
+    : rest_(rest), delim_(delim), done_(false) {
+  ++*this;
+}
+
+SplitRange::Iterator& SplitRange::Iterator::operator++() {
+  if (last_) {
+    done_ = true;
+    return *this;
+  }
+  size_t found = delim_.Empty() ? StringView::kNpos : rest_.Find(delim_);
+  if (found == StringView::kNpos) {
+    piece_ = rest_;
+    last_ = true;
+    return *this;
+  }
+  piece_ = rest_.Substr(0, found);
+  rest_.RemovePrefix(found + delim_.Size());
+  return *this;
+}
+
+SplitRange::Iterator SplitRange::Iterator::operator++(int) {
+  Iterator copy = *this;
+  ++*this;
+  return copy;
+}
+
+bool operator<(StringView first, StringView second) {
+  int cmp = memcmp(first.Data(), second.Data(), std::min(first.Size(), second.Size()));
+  return cmp != 0 ? cmp < 0 : first.Size() < second.Size();
+}
+
+bool operator==(StringView first, StringView second) {
+  return first.Size() == second.Size() &&
+         memcmp(first.Data(), second.Data(), first.Size()) == 0;
+}
+
+bool operator!=(StringView first, StringView second) { return !(first == second); }
+
+bool operator>(StringView first, StringView second) { return second < first; }
+
+bool operator<=(StringView first, StringView second) { return !(first > second); }
+
+bool operator>=(StringView first, StringView second) { return !(first < second); }
+
+std::ostream& operator<<(std::ostream& out, StringView view) {
+  return out.write(view.Data(), view.Size());
 }
\ No newline at end of file
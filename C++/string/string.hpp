@@ -1,21 +1,142 @@
 #pragma once
 
+#include <bit>
+#include <concepts>
+#include <cstddef>
 #include <cstring>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
 #include <vector>
 
+class String;
+
+class SplitRange;
+
+// Non-owning reference to a range of chars, e.g. a part of a String. It must
+// not outlive the buffer it points into.
+class StringView {
+ public:
+  static const size_t kNpos = static_cast<size_t>(-1);
+
+  StringView() = default;
+
+  StringView(const char* data, size_t size) : data_(data), size_(size) {}
+
+  StringView(const char* str) : data_(str), size_(strlen(str)) {}
+
+  StringView(const String& str);
+
+  const char& operator[](size_t index) const { return data_[index]; }
+
+  const char& Front() const { return data_[0]; }
+
+  const char& Back() const { return data_[size_ - 1]; }
+
+  bool Empty() const { return size_ == 0; }
+
+  size_t Size() const { return size_; }
+
+  const char* Data() const { return data_; }
+
+  const char* begin() const { return data_; }
+
+  const char* end() const { return data_ + size_; }
+
+  void RemovePrefix(size_t count);
+
+  void RemoveSuffix(size_t count);
+
+  StringView Substr(size_t pos, size_t count = kNpos) const;
+
+  size_t Find(StringView needle, size_t pos = 0) const;
+
+  size_t RFind(StringView needle, size_t pos = kNpos) const;
+
+  bool Contains(StringView needle) const;
+
+  std::vector<StringView> Split(StringView delim = " ") const;
+
+  SplitRange Tokenize(StringView delim = " ") const;
+
+  size_t Hash() const;
+
+ private:
+  const char* data_ = "";
+  size_t size_ = 0;
+};
+
+// Lazy sequence of the views Split would return, found one by one.
+class SplitRange {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = StringView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const StringView*;
+    using reference = const StringView&;
+
+    Iterator() = default;
+
+    const StringView& operator*() const { return piece_; }
+
+    const StringView* operator->() const { return &piece_; }
+
+    Iterator& operator++();
+
+    Iterator operator++(int);
+
+    bool operator==(const Iterator& other) const {
+      return done_ == other.done_ && (done_ || piece_.Data() == other.piece_.Data());
+    }
+
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class SplitRange;
+
+    Iterator(StringView rest, StringView delim);
+
+    StringView rest_;
+    StringView delim_;
+    StringView piece_;
+    bool last_ = false;
+    bool done_ = true;
+  };
+
+  SplitRange(StringView source, StringView delim) : source_(source), delim_(delim) {}
+
+  Iterator begin() const { return Iterator(source_, delim_); }
+
+  Iterator end() const { return Iterator(); }
+
+ private:
+  StringView source_;
+  StringView delim_;
+};
+
 class String {
  public:
+  static const size_t kNpos = static_cast<size_t>(-1);
+
   String() = default;
 
   String(size_t size, char character);
 
   String(const char* ptr_input);
 
+  explicit String(StringView view);
+
   String(const String& other);
 
+  String(String&& other) noexcept;
+
   String& operator=(const String& other);
 
+  String& operator=(String&& other) noexcept;
+
   ~String();
 
   void Clear();
@@ -58,18 +179,66 @@ class String {
 
   String& operator+=(const String& other);
 
+  // Appends size chars at once, growing the buffer at least twofold.
+  String& Append(const char* data, size_t size);
+
   String& operator*=(size_t num);
 
+  // Position of the first (last) occurrence of needle starting at (not after)
+  // pos, or kNpos.
+  size_t Find(StringView needle, size_t pos = 0) const;
+
+  size_t RFind(StringView needle, size_t pos = kNpos) const;
+
+  bool Contains(StringView needle) const;
+
   std::vector<String> Split(const String& delim = " ");
 
+  // Pieces between occurrences of delim as views into this string, produced
+  // lazily without copying.
+  SplitRange Tokenize(StringView delim = " ") const;
+
   String Join(const std::vector<String>& strings) const;
 
  private:
+  friend class SharedString;
+
+  // Hands the heap buffer over to the caller and leaves the string empty.
+  // Returns nullptr for short strings, which own no heap buffer.
+  char* ReleaseBuffer();
+
+  struct LongRep {
+    char* ptr;
+    size_t size;
+    size_t capacity;
+  };
+
+  // Strings up to kShortCapacity chars live inside the object. The last byte
+  // then holds the size, for heap strings it carries kLongFlag through the
+  // capacity word.
+  static const size_t kShortCapacity = sizeof(LongRep) - 2;
+
+  static const bool kLittleEndian = (std::endian::native == std::endian::little);
+
+  static const size_t kLongFlag =
+      kLittleEndian ? size_t(0x80) << (8 * (sizeof(size_t) - 1)) : size_t(0x80);
+
+  bool IsLong() const {
+    return (static_cast<unsigned char>(short_[sizeof(LongRep) - 1]) & 0x80) != 0;
+  }
+
+  char* Ptr() { return IsLong() ? long_.ptr : short_; }
+
+  const char* Ptr() const { return IsLong() ? long_.ptr : short_; }
+
+  void SetSize(size_t new_size);
+
   void NewCapacity(size_t new_cap);
 
-  size_t size_ = 0;
-  char* ptr_ = nullptr;
-  size_t capacity_ = 0;
+  union {
+    LongRep long_;
+    char short_[sizeof(LongRep)] = {};
+  };
 };
 
 bool operator<(const String& first, const String& second);
@@ -86,8 +255,109 @@ bool operator>=(const String& first, const String& second);
 
 String operator+(const String& first, const String& second);
 
+String operator+(String&& first, const String& second);
+
 String operator*(const String& str, size_t num);
 
 std::ostream& operator<<(std::ostream& out, const String& str);
 
-std::istream& operator>>(std::istream& input, String& str);
\ No newline at end of file
+// Reads a whitespace-delimited word, replacing the contents of str. The buffer
+// of str is reused, so reading repeatedly into one String stops allocating.
+std::istream& operator>>(std::istream& input, String& str);
+
+// Streams with their own buffer, like stdlike::ostream and stdlike::istream,
+// exchange whole runs of chars with it instead of going char by char.
+template <typename Stream>
+concept SpanOutput = requires(Stream& out, const char* data, size_t size) {
+  out.write_span(data, size);
+};
+
+template <typename Stream>
+concept WordInput = requires(Stream& input, void (*sink)(const char*, size_t)) {
+  input.read_word(sink);
+};
+
+template <SpanOutput Stream>
+Stream& operator<<(Stream& out, const String& str) {
+  out.write_span(str.Data(), str.Size());
+  return out;
+}
+
+template <WordInput Stream>
+Stream& operator>>(Stream& input, String& str) {
+  str.Clear();
+  input.read_word([&str](const char* data, size_t size) { str.Append(data, size); });
+  return input;
+}
+
+bool operator<(StringView first, StringView second);
+
+bool operator==(StringView first, StringView second);
+
+bool operator!=(StringView first, StringView second);
+
+bool operator>(StringView first, StringView second);
+
+bool operator<=(StringView first, StringView second);
+
+bool operator>=(StringView first, StringView second);
+
+std::ostream& operator<<(std::ostream& out, StringView view);
+
+template <SpanOutput Stream>
+Stream& operator<<(Stream& out, StringView view) {
+  out.write_span(view.Data(), view.Size());
+  return out;
+}
+
+template <>
+struct std::hash<StringView> {
+  size_t operator()(StringView view) const { return view.Hash(); }
+};
+
+template <>
+struct std::hash<String> {
+  size_t operator()(const String& str) const { return StringView(str).Hash(); }
+};
+
+// A view with its hash computed once, for keys looked up over and over.
+class HashedStringView {
+ public:
+  HashedStringView(StringView view) : view_(view), hash_(view.Hash()) {}
+
+  HashedStringView(const char* str) : HashedStringView(StringView(str)) {}
+
+  HashedStringView(const String& str) : HashedStringView(StringView(str)) {}
+
+  StringView View() const { return view_; }
+
+  size_t Hash() const { return hash_; }
+
+ private:
+  StringView view_;
+  size_t hash_;
+};
+
+// Argument of StrCat: a String, a C string or a single char. Other integers
+// do not convert to char: StrCat("n=", 5) does not compile rather than append
+// '\x05'.
+struct StrCatPiece {
+  StrCatPiece(const String& str) : data(str.Data()), size(str.Size()) {}
+
+  StrCatPiece(const char* str) : data(str), size(strlen(str)) {}
+
+  template <std::same_as<char> Char>
+  StrCatPiece(const Char& sym) : data(&sym), size(1) {}
+
+  const char* data;
+  size_t size;
+};
+
+// Concatenates all pieces with a single allocation of the exact size.
+String StrCat(std::initializer_list<StrCatPiece> pieces);
+
+template <typename... Args>
+  requires(std::constructible_from<StrCatPiece, const Args&> && ...)
+String StrCat(const Args&... args) {
+  return StrCat({StrCatPiece(args)...});
+}
\ No newline at end of file
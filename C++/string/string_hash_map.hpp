@@ -0,0 +1,359 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "string.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Open-addressing map from String to Value in the style of Swiss tables. Every
+// slot has a control byte: empty, deleted, or the low 7 bits of its key's
+// hash. A lookup compares 16 control bytes at once and touches keys only on a
+// 7-bit match. Keys can be looked up by StringView, C string or
+// HashedStringView without building a String; one is made only on insertion.
+template <typename Value>
+class StringHashMap {
+ public:
+  StringHashMap() = default;
+
+  StringHashMap(const StringHashMap& other);
+
+  StringHashMap(StringHashMap&& other) noexcept { Swap(other); }
+
+  StringHashMap& operator=(const StringHashMap& other);
+
+  StringHashMap& operator=(StringHashMap&& other) noexcept;
+
+  ~StringHashMap();
+
+  size_t Size() const { return size_; }
+
+  bool Empty() const { return size_ == 0; }
+
+  size_t Capacity() const { return capacity_; }
+
+  Value* Find(HashedStringView key);
+
+  const Value* Find(HashedStringView key) const;
+
+  bool Contains(HashedStringView key) const { return Find(key) != nullptr; }
+
+  // Inserts key -> value unless key is present. Returns the mapped value and
+  // whether it was inserted.
+  std::pair<Value*, bool> Insert(HashedStringView key, Value value);
+
+  Value& operator[](HashedStringView key);
+
+  bool Erase(HashedStringView key);
+
+  void Clear();
+
+  void Reserve(size_t count);
+
+  void Swap(StringHashMap& other);
+
+  // Calls func(const String& key, Value& value) for every entry.
+  template <typename Func>
+  void ForEach(Func func);
+
+  template <typename Func>
+  void ForEach(Func func) const;
+
+ private:
+  struct Slot {
+    String key;
+    Value value;
+  };
+
+  static const size_t kGroupSize = 16;
+
+  static const int8_t kEmpty = -128;
+
+  static const int8_t kDeleted = -2;
+
+  // Bit i is set if control byte i of the group at ctrl satisfies the test.
+  static uint32_t Match(const int8_t* ctrl, int8_t byte);
+
+  static uint32_t MatchFree(const int8_t* ctrl);
+
+  static size_t MaxLoad(size_t capacity) { return capacity / 8 * 7; }
+
+  // Index of the slot holding key, or capacity_ if there is none.
+  size_t Locate(HashedStringView key) const;
+
+  // Index of the first empty or deleted slot on the probe path of hash.
+  size_t FreeSlot(size_t hash) const;
+
+  // Stores key -> value, key must not be present.
+  Value* Emplace(HashedStringView key, Value value);
+
+  void Rehash(size_t new_capacity);
+
+  void Destroy();
+
+  int8_t* ctrl_ = nullptr;
+  Slot* slots_ = nullptr;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  size_t growth_left_ = 0;
+};
+
+template <typename Value>
+StringHashMap<Value>::StringHashMap(const StringHashMap& other) {
+  Reserve(other.size_);
+  other.ForEach([this](const String& key, const Value& value) { Insert(key, value); });
+}
+
+template <typename Value>
+StringHashMap<Value>& StringHashMap<Value>::operator=(const StringHashMap& other) {
+  if (this != &other) {
+    StringHashMap copy(other);
+    Swap(copy);
+  }
+  return *this;
+}
+
+template <typename Value>
+StringHashMap<Value>& StringHashMap<Value>::operator=(StringHashMap&& other) noexcept {
+  if (this != &other) {
+    Destroy();
+    Swap(other);
+  }
+  return *this;
+}
+
+template <typename Value>
+StringHashMap<Value>::~StringHashMap() {
+  Destroy();
+}
+
+template <typename Value>
+Value* StringHashMap<Value>::Find(HashedStringView key) {
+  size_t index = Locate(key);
+  return index == capacity_ ? nullptr : &slots_[index].value;
+}
+
+template <typename Value>
+const Value* StringHashMap<Value>::Find(HashedStringView key) const {
+  size_t index = Locate(key);
+  return index == capacity_ ? nullptr : &slots_[index].value;
+}
+
+template <typename Value>
+std::pair<Value*, bool> StringHashMap<Value>::Insert(HashedStringView key, Value value) {
+  size_t index = Locate(key);
+  if (index != capacity_) {
+    return {&slots_[index].value, false};
+  }
+  return {Emplace(key, std::move(value)), true};
+}
+
+template <typename Value>
+Value& StringHashMap<Value>::operator[](HashedStringView key) {
+  size_t index = Locate(key);
+  return index != capacity_ ? slots_[index].value : *Emplace(key, Value());
+}
+
+template <typename Value>
+Value* StringHashMap<Value>::Emplace(HashedStringView key, Value value) {
+  size_t index = capacity_ == 0 ? 0 : FreeSlot(key.Hash());
+  if (capacity_ == 0 || (growth_left_ == 0 && ctrl_[index] != kDeleted)) {
+    // Grow only if at least half of the load is live; otherwise just sweep
+    // out the deleted slots.
+    Rehash(capacity_ == 0 ? kGroupSize : (size_ + 1 > MaxLoad(capacity_) / 2 ? capacity_ * 2 : capacity_));
+    index = FreeSlot(key.Hash());
+  }
+  if (ctrl_[index] == kEmpty) {
+    --growth_left_;
+  }
+  new (&slots_[index]) Slot{String(key.View()), std::move(value)};
+  ctrl_[index] = static_cast<int8_t>(key.Hash() & 0x7F);
+  ++size_;
+  return &slots_[index].value;
+}
+
+template <typename Value>
+bool StringHashMap<Value>::Erase(HashedStringView key) {
+  size_t index = Locate(key);
+  if (index == capacity_) {
+    return false;
+  }
+  slots_[index].~Slot();
+  --size_;
+  // Lookups stop at the first group with an empty slot, so if this group
+  // already had one, no probe path runs through it and the slot can be empty.
+  size_t group = index - index % kGroupSize;
+  if (MatchFree(ctrl_ + group) != Match(ctrl_ + group, kDeleted)) {
+    ctrl_[index] = kEmpty;
+    ++growth_left_;
+  } else {
+    ctrl_[index] = kDeleted;
+  }
+  return true;
+}
+
+template <typename Value>
+void StringHashMap<Value>::Clear() {
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (ctrl_[i] >= 0) {
+      slots_[i].~Slot();
+    }
+    ctrl_[i] = kEmpty;
+  }
+  size_ = 0;
+  growth_left_ = MaxLoad(capacity_);
+}
+
+template <typename Value>
+void StringHashMap<Value>::Reserve(size_t count) {
+  size_t new_capacity = capacity_ == 0 ? kGroupSize : capacity_;
+  while (MaxLoad(new_capacity) < count) {
+    new_capacity *= 2;
+  }
+  if (new_capacity > capacity_) {
+    Rehash(new_capacity);
+  }
+}
+
+template <typename Value>
+void StringHashMap<Value>::Swap(StringHashMap& other) {
+  std::swap(ctrl_, other.ctrl_);
+  std::swap(slots_, other.slots_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(size_, other.size_);
+  std::swap(growth_left_, other.growth_left_);
+}
+
+template <typename Value>
+template <typename Func>
+void StringHashMap<Value>::ForEach(Func func) {
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (ctrl_[i] >= 0) {
+      func(const_cast<const String&>(slots_[i].key), slots_[i].value);
+    }
+  }
+}
+
+template <typename Value>
+template <typename Func>
+void StringHashMap<Value>::ForEach(Func func) const {
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (ctrl_[i] >= 0) {
+      func(slots_[i].key, const_cast<const Value&>(slots_[i].value));
+    }
+  }
+}
+
+template <typename Value>
+uint32_t StringHashMap<Value>::Match(const int8_t* ctrl, int8_t byte) {
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte))));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kGroupSize; ++i) {
+    mask |= static_cast<uint32_t>(ctrl[i] == byte) << i;
+  }
+  return mask;
+#endif
+}
+
+template <typename Value>
+uint32_t StringHashMap<Value>::MatchFree(const int8_t* ctrl) {
+  // Empty and deleted are the only negative control bytes.
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+  return static_cast<uint32_t>(_mm_movemask_epi8(group));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kGroupSize; ++i) {
+    mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+template <typename Value>
+size_t StringHashMap<Value>::Locate(HashedStringView key) const {
+  if (capacity_ == 0) {
+    return 0;
+  }
+  size_t group_mask = capacity_ / kGroupSize - 1;
+  size_t group = (key.Hash() >> 7) & group_mask;
+  int8_t tag = static_cast<int8_t>(key.Hash() & 0x7F);
+  // Triangular probing visits every group once when their count is a power of two.
+  for (size_t step = 1;; ++step) {
+    const int8_t* ctrl = ctrl_ + group * kGroupSize;
+    for (uint32_t mask = Match(ctrl, tag); mask != 0; mask &= mask - 1) {
+      size_t index = group * kGroupSize + std::countr_zero(mask);
+      if (slots_[index].key == key.View()) {
+        return index;
+      }
+    }
+    if (Match(ctrl, kEmpty) != 0 || step > group_mask) {
+      return capacity_;
+    }
+    group = (group + step) & group_mask;
+  }
+}
+
+template <typename Value>
+size_t StringHashMap<Value>::FreeSlot(size_t hash) const {
+  size_t group_mask = capacity_ / kGroupSize - 1;
+  size_t group = (hash >> 7) & group_mask;
+  for (size_t step = 1;; ++step) {
+    uint32_t mask = MatchFree(ctrl_ + group * kGroupSize);
+    if (mask != 0) {
+      return group * kGroupSize + std::countr_zero(mask);
+    }
+    group = (group + step) & group_mask;
+  }
+}
+
+template <typename Value>
+void StringHashMap<Value>::Rehash(size_t new_capacity) {
+  int8_t* old_ctrl = ctrl_;
+  Slot* old_slots = slots_;
+  size_t old_capacity = capacity_;
+
+  ctrl_ = new int8_t[new_capacity];
+  memset(ctrl_, kEmpty, new_capacity);
+  slots_ = std::allocator<Slot>().allocate(new_capacity);
+  capacity_ = new_capacity;
+  growth_left_ = MaxLoad(new_capacity) - size_;
+
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (old_ctrl[i] >= 0) {
+      size_t index = FreeSlot(StringView(old_slots[i].key).Hash());
+      new (&slots_[index]) Slot(std::move(old_slots[i]));
+      ctrl_[index] = old_ctrl[i];
+      old_slots[i].~Slot();
+    }
+  }
+  delete[] old_ctrl;
+  if (old_slots != nullptr) {
+    std::allocator<Slot>().deallocate(old_slots, old_capacity);
+  }
+}
+
+template <typename Value>
+void StringHashMap<Value>::Destroy() {
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (ctrl_[i] >= 0) {
+      slots_[i].~Slot();
+    }
+  }
+  delete[] ctrl_;
+  if (slots_ != nullptr) {
+    std::allocator<Slot>().deallocate(slots_, capacity_);
+  }
+  ctrl_ = nullptr;
+  slots_ = nullptr;
+  capacity_ = size_ = growth_left_ = 0;
+}
\ No newline at end of file
@@ -0,0 +1,657 @@
+#include "utf8.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define UTF8_X86_KERNELS
+#endif
+
+namespace {
+
+// Decodes the sequence at data into code_point. Returns its length, or 0 if
+// it is malformed.
+size_t DecodeUtf8(const unsigned char* data, size_t avail, char32_t& code_point) {
+  unsigned char lead = data[0];
+  if (lead < 0x80) {
+    code_point = lead;
+    return 1;
+  }
+  size_t length;
+  unsigned char low = 0x80;
+  unsigned char high = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    code_point = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    code_point = lead & 0x0F;
+    low = lead == 0xE0 ? 0xA0 : 0x80;
+    high = lead == 0xED ? 0x9F : 0xBF;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    code_point = lead & 0x07;
+    low = lead == 0xF0 ? 0x90 : 0x80;
+    high = lead == 0xF4 ? 0x8F : 0xBF;
+  } else {
+    return 0;
+  }
+  if (avail < length || data[1] < low || data[1] > high) {
+    return 0;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    if (i > 1 && (data[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+    code_point = (code_point << 6) | (data[i] & 0x3F);
+  }
+  return length;
+}
+
+size_t EncodeUtf8(char32_t code_point, char* out) {
+  if (code_point < 0x80) {
+    out[0] = static_cast<char>(code_point);
+    return 1;
+  }
+  if (code_point < 0x800) {
+    out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+    out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+    return 2;
+  }
+  if (code_point < 0x10000) {
+    out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+    out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+    return 3;
+  }
+  out[0] = static_cast<char>(0xF0 | (code_point >> 18));
+  out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+  out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+  out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+  return 4;
+}
+
+bool IsScalarValue(char32_t code_point) {
+  return code_point < 0xD800 || (code_point > 0xDFFF && code_point <= 0x10FFFF);
+}
+
+// Length of the ASCII run at the start of data, found 16 bytes at a time.
+size_t AsciiPrefix(const unsigned char* data, size_t size) {
+  size_t pos = 0;
+#ifdef __SSE2__
+  for (; pos + 16 <= size; pos += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    int mask = _mm_movemask_epi8(block);
+    if (mask != 0) {
+      return pos + std::countr_zero(static_cast<unsigned>(mask));
+    }
+  }
+#endif
+  while (pos < size && data[pos] < 0x80) {
+    ++pos;
+  }
+  return pos;
+}
+
+// Widens an ASCII run into UTF-16 or UTF-32 units.
+template <typename Char>
+void WidenAscii(const unsigned char* data, size_t size, Char* out) {
+  size_t pos = 0;
+#ifdef __SSE2__
+  __m128i zero = _mm_setzero_si128();
+  for (; pos + 16 <= size; pos += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i low = _mm_unpacklo_epi8(block, zero);
+    __m128i high = _mm_unpackhi_epi8(block, zero);
+    if constexpr (sizeof(Char) == 2) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos), low);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos + 8), high);
+    } else {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos), _mm_unpacklo_epi16(low, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos + 4), _mm_unpackhi_epi16(low, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos + 8), _mm_unpacklo_epi16(high, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + pos + 12), _mm_unpackhi_epi16(high, zero));
+    }
+  }
+#endif
+  for (; pos < size; ++pos) {
+    out[pos] = data[pos];
+  }
+}
+
+#ifdef UTF8_X86_KERNELS
+// Shuffles that move the 16-bit lanes selected by an 8-bit mask to the front
+// of a register, in order.
+struct LanePackTable {
+  uint8_t shuffles[256][16];
+
+  constexpr LanePackTable() : shuffles() {
+    for (int mask = 0; mask < 256; ++mask) {
+      int lanes = 0;
+      for (int lane = 0; lane < 8; ++lane) {
+        if ((mask & (1 << lane)) != 0) {
+          shuffles[mask][2 * lanes] = static_cast<uint8_t>(2 * lane);
+          shuffles[mask][2 * lanes + 1] = static_cast<uint8_t>(2 * lane + 1);
+          ++lanes;
+        }
+      }
+      for (; lanes < 8; ++lanes) {
+        shuffles[mask][2 * lanes] = 0x80;
+        shuffles[mask][2 * lanes + 1] = 0x80;
+      }
+    }
+  }
+};
+
+constexpr LanePackTable kLanePack;
+
+__attribute__((target("ssse3"))) __m128i Select(__m128i mask, __m128i yes, __m128i no) {
+  return _mm_or_si128(_mm_and_si128(mask, yes), _mm_andnot_si128(mask, no));
+}
+
+// Decodes the sequences that start in the 16 bytes at data, which must be a
+// sequence boundary with 18 readable bytes, when they are all valid and at
+// most three bytes long. Returns the bytes consumed, past the block if its
+// last sequence runs over, and sets written; returns 0 to leave the block to
+// the scalar decoder. out needs room for 16 units.
+//
+// The high and low byte of the code point starting at every position are
+// computed from that byte and the two after it, the bytes are interleaved into
+// 16-bit lanes and the lanes of continuation bytes are squeezed out.
+//
+// Early SSSE3 parts lack POPCNT; without it in the target std::popcount
+// becomes a library call per block.
+template <typename Char>
+__attribute__((target("ssse3,popcnt"))) size_t DecodeBlockSsse3(const unsigned char* data, Char* out, size_t& written) {
+  __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 1));
+  __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2));
+  auto set = [](int value) { return _mm_set1_epi8(static_cast<char>(value)); };
+  auto match = [&set](__m128i bytes, int mask, int value) {
+    return _mm_cmpeq_epi8(_mm_and_si128(bytes, set(mask)), set(value));
+  };
+
+  // F0 and up (four-byte leads and invalid bytes) and the overlong C0, C1.
+  if (_mm_movemask_epi8(_mm_or_si128(match(b0, 0xF0, 0xF0), match(b0, 0xFE, 0xC0))) != 0) {
+    return 0;
+  }
+  __m128i is_two = match(b0, 0xE0, 0xC0);
+  __m128i is_three = match(b0, 0xF0, 0xE0);
+
+  // Structure: continuation bytes exactly where the leads ask for them, up to
+  // the end of the sequence that starts last in the block.
+  uint32_t conts = _mm_movemask_epi8(match(b0, 0xC0, 0x80)) | (_mm_movemask_epi8(match(b2, 0xC0, 0x80)) << 2);
+  uint32_t twos = _mm_movemask_epi8(is_two);
+  uint32_t threes = _mm_movemask_epi8(is_three);
+  size_t length = 16 + ((threes >> 15) & 1) * 2 + ((threes >> 14) & 1) + ((twos >> 15) & 1);
+  uint32_t range = (1u << length) - 1;
+  uint32_t expected = (twos << 1) | (threes << 1) | (threes << 2);
+
+  __m128i low6 = set(0x3F);
+  __m128i two_low = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(b0, 6), set(0xC0)), _mm_and_si128(b1, low6));
+  __m128i two_high = _mm_and_si128(_mm_srli_epi16(b0, 2), set(0x07));
+  __m128i three_low = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(b1, 6), set(0xC0)), _mm_and_si128(b2, low6));
+  __m128i three_high =
+      _mm_or_si128(_mm_and_si128(_mm_slli_epi16(b0, 4), set(0xF0)), _mm_and_si128(_mm_srli_epi16(b1, 2), set(0x0F)));
+  // Three-byte forms below U+0800 are overlong, D800-DFFF are surrogates.
+  __m128i top = _mm_and_si128(three_high, set(0xF8));
+  __m128i bad =
+      _mm_and_si128(is_three, _mm_or_si128(_mm_cmpeq_epi8(top, _mm_setzero_si128()), _mm_cmpeq_epi8(top, set(0xD8))));
+  if (_mm_movemask_epi8(bad) != 0 || (conts & range) != (expected & range)) {
+    return 0;
+  }
+
+  __m128i low = Select(is_three, three_low, Select(is_two, two_low, b0));
+  __m128i high = Select(is_three, three_high, _mm_and_si128(is_two, two_high));
+  uint32_t keep = ~conts & 0xFFFF;
+  __m128i first = _mm_shuffle_epi8(_mm_unpacklo_epi8(low, high),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(kLanePack.shuffles[keep & 0xFF])));
+  __m128i second = _mm_shuffle_epi8(_mm_unpackhi_epi8(low, high),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(kLanePack.shuffles[keep >> 8])));
+  size_t first_count = std::popcount(keep & 0xFF);
+  if constexpr (sizeof(Char) == 2) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), first);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + first_count), second);
+  } else {
+    __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(first, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(first, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + first_count), _mm_unpacklo_epi16(second, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + first_count + 4), _mm_unpackhi_epi16(second, zero));
+  }
+  written = std::popcount(keep);
+  return length;
+}
+#endif
+
+// Decodes str into UTF-16 or UTF-32 units; out must have room for str.Size().
+// Runs of one to three byte sequences go through DecodeBlockSsse3 where the
+// CPU has SSSE3 and POPCNT, four-byte and malformed sequences through DecodeUtf8.
+template <typename Char>
+size_t TranscodeUtf8(StringView str, Char* out) {
+  const auto* data = reinterpret_cast<const unsigned char*>(str.Data());
+  size_t size = str.Size();
+  size_t written = 0;
+  size_t pos = 0;
+  while (pos < size) {
+    size_t ascii = AsciiPrefix(data + pos, size - pos);
+    WidenAscii(data + pos, ascii, out + written);
+    pos += ascii;
+    written += ascii;
+    if (pos == size) {
+      break;
+    }
+    size_t scalar_end = pos + 1;
+#ifdef UTF8_X86_KERNELS
+    static const bool kSsse3 = __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("popcnt");
+    if (kSsse3) {
+      size_t consumed = 1;
+      while (pos + 18 <= size && consumed != 0) {
+        size_t units = 0;
+        consumed = DecodeBlockSsse3(data + pos, out + written, units);
+        pos += consumed;
+        written += units;
+      }
+      // A rejected block and the tail go to the scalar decoder whole, so
+      // text full of four-byte sequences pays one vector attempt per block.
+      scalar_end = pos + 16;
+    }
+#endif
+    while (pos < size && pos < scalar_end) {
+      if (data[pos] < 0x80) {
+        out[written++] = data[pos++];
+        continue;
+      }
+      char32_t code_point;
+      size_t length = DecodeUtf8(data + pos, size - pos, code_point);
+      if (length == 0) {
+        code_point = kReplacementChar;
+        length = 1;
+      }
+      pos += length;
+      if (sizeof(Char) == 2 && code_point >= 0x10000) {
+        code_point -= 0x10000;
+        out[written++] = static_cast<Char>(0xD800 | (code_point >> 10));
+        out[written++] = static_cast<Char>(0xDC00 | (code_point & 0x3FF));
+      } else {
+        out[written++] = static_cast<Char>(code_point);
+      }
+    }
+  }
+  return written;
+}
+
+#ifdef UTF8_X86_KERNELS
+// Vector validation after Keiser and Lemire, "Validating UTF-8 In Less Than
+// One Instruction Per Byte". Every byte is classified together with the one
+// before it by three 16-entry table lookups (high nibble of the previous
+// byte, its low nibble, high nibble of the current byte); each bit of the
+// tables stands for one kind of error, and a bit surviving the AND of all
+// three is an error. Third and fourth bytes of a sequence are checked apart:
+// they must be continuations exactly where the byte two or three back is a
+// three or four byte lead.
+const uint8_t kTooShort = 1 << 0;     // lead or ASCII where a continuation is due
+const uint8_t kTooLong = 1 << 1;      // continuation after ASCII
+const uint8_t kOverlong3 = 1 << 2;    // E0 80..9F
+const uint8_t kTooLarge = 1 << 3;     // past U+10FFFF
+const uint8_t kSurrogate = 1 << 4;    // ED A0..BF
+const uint8_t kOverlong2 = 1 << 5;    // C0, C1
+const uint8_t kTooLarge1000 = 1 << 6; // F5.. 80..8F
+const uint8_t kOverlong4 = 1 << 6;    // F0 80..8F
+const uint8_t kTwoConts = 1 << 7;     // continuation after continuation
+const uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+// Indexed by the high nibble of the previous byte.
+const uint8_t kByte1High[16] = {
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    kTooShort | kOverlong2,
+    kTooShort,
+    kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4};
+
+// Indexed by the low nibble of the previous byte.
+const uint8_t kByte1Low[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000};
+
+// Indexed by the high nibble of the current byte.
+const uint8_t kByte2High[16] = {
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooShort, kTooShort, kTooShort, kTooShort};
+
+using Utf8Validator = bool (*)(const unsigned char*, size_t);
+
+__attribute__((target("ssse3")))
+__m128i Utf8Errors(__m128i input, __m128i prev, __m128i byte_1_high, __m128i byte_1_low,
+                   __m128i byte_2_high) {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+  __m128i special = _mm_and_si128(
+      _mm_and_si128(
+          _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+          _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+      _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+  // Only bytes from E0 (F0) up keep bit 7 after the saturating subtraction.
+  __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14), _mm_set1_epi8(0xE0 - 0x80));
+  __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13), _mm_set1_epi8(0xF0 - 0x80));
+  __m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+  return _mm_xor_si128(must_continue, special);
+}
+
+// The input is followed by a zero-padded block, so a sequence cut off at the
+// end shows up as too short.
+__attribute__((target("ssse3")))
+bool IsValidUtf8Ssse3(const unsigned char* data, size_t size) {
+  const __m128i byte_1_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kByte1High));
+  const __m128i byte_1_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kByte1Low));
+  const __m128i byte_2_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kByte2High));
+  __m128i prev = _mm_setzero_si128();
+  __m128i error = _mm_setzero_si128();
+  size_t pos = 0;
+  for (; pos + 16 <= size; pos += 16) {
+    __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    if (_mm_movemask_epi8(_mm_or_si128(input, prev)) != 0) {
+      error = _mm_or_si128(error, Utf8Errors(input, prev, byte_1_high, byte_1_low, byte_2_high));
+    }
+    prev = input;
+  }
+  unsigned char tail[16] = {};
+  std::memcpy(tail, data + pos, size - pos);
+  __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail));
+  error = _mm_or_si128(error, Utf8Errors(input, prev, byte_1_high, byte_1_low, byte_2_high));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+__attribute__((target("avx2")))
+__m256i Utf8Errors(__m256i input, __m256i prev, __m256i byte_1_high, __m256i byte_1_low,
+                   __m256i byte_2_high) {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  // alignr works within 128-bit lanes; pair each lane with the one before it.
+  __m256i shifted = _mm256_permute2x128_si256(prev, input, 0x21);
+  __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+  __m256i special = _mm256_and_si256(
+      _mm256_and_si256(
+          _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+          _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))),
+      _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+  __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 14), _mm256_set1_epi8(0xE0 - 0x80));
+  __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 13), _mm256_set1_epi8(0xF0 - 0x80));
+  __m256i must_continue =
+      _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must_continue, special);
+}
+
+__attribute__((target("avx2")))
+bool IsValidUtf8Avx2(const unsigned char* data, size_t size) {
+  const __m256i byte_1_high =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kByte1High)));
+  const __m256i byte_1_low =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kByte1Low)));
+  const __m256i byte_2_high =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kByte2High)));
+  __m256i prev = _mm256_setzero_si256();
+  __m256i error = _mm256_setzero_si256();
+  size_t pos = 0;
+  for (; pos + 32 <= size; pos += 32) {
+    __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    if (_mm256_movemask_epi8(_mm256_or_si256(input, prev)) != 0) {
+      error = _mm256_or_si256(error, Utf8Errors(input, prev, byte_1_high, byte_1_low, byte_2_high));
+    }
+    prev = input;
+  }
+  unsigned char tail[32] = {};
+  std::memcpy(tail, data + pos, size - pos);
+  __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail));
+  error = _mm256_or_si256(error, Utf8Errors(input, prev, byte_1_high, byte_1_low, byte_2_high));
+  return _mm256_testz_si256(error, error) != 0;
+}
+
+Utf8Validator SelectUtf8Validator() {
+  if (__builtin_cpu_supports("avx2")) {
+    return IsValidUtf8Avx2;
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return IsValidUtf8Ssse3;
+  }
+  return nullptr;
+}
+#endif
+
+}  // namespace
+
+bool IsValidUtf8(StringView str) {
+  const auto* data = reinterpret_cast<const unsigned char*>(str.Data());
+  size_t size = str.Size();
+#ifdef UTF8_X86_KERNELS
+  static const Utf8Validator kValidator = SelectUtf8Validator();
+  if (kValidator != nullptr) {
+    return kValidator(data, size);
+  }
+#endif
+  size_t pos = 0;
+  while (pos < size) {
+    pos += AsciiPrefix(data + pos, size - pos);
+    if (pos == size) {
+      break;
+    }
+    char32_t code_point;
+    size_t length = DecodeUtf8(data + pos, size - pos, code_point);
+    if (length == 0) {
+      return false;
+    }
+    pos += length;
+  }
+  return true;
+}
+
+size_t CountCodePoints(StringView str) {
+  if (IsValidUtf8(str)) {
+    // Every byte but a continuation byte (0x80-0xBF) starts a code point.
+    const auto* data = reinterpret_cast<const unsigned char*>(str.Data());
+    size_t size = str.Size();
+    size_t count = 0;
+    size_t pos = 0;
+#ifdef __SSE2__
+    __m128i bound = _mm_set1_epi8(static_cast<char>(0xBF));
+    for (; pos + 16 <= size; pos += 16) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+      int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(block, bound));
+      count += std::popcount(static_cast<unsigned>(mask));
+    }
+#endif
+    for (; pos < size; ++pos) {
+      count += (data[pos] & 0xC0) != 0x80;
+    }
+    return count;
+  }
+  size_t count = 0;
+  for (auto it = CodePoints(str).begin(), end = CodePoints(str).end(); it != end; ++it) {
+    ++count;
+  }
+  return count;
+}
+
+std::u16string Utf8ToUtf16(StringView str) {
+  std::u16string res(str.Size(), u'\0');
+  res.resize(TranscodeUtf8(str, res.data()));
+  return res;
+}
+
+std::u32string Utf8ToUtf32(StringView str) {
+  std::u32string res(str.Size(), U'\0');
+  res.resize(TranscodeUtf8(str, res.data()));
+  return res;
+}
+
+String Utf16ToUtf8(std::u16string_view str) {
+  String res;
+  res.Resize(str.size() * 3);
+  char* out = res.Data();
+  size_t written = 0;
+  for (size_t pos = 0; pos < str.size(); ++pos) {
+    char32_t code_point = str[pos];
+    if (code_point >= 0xD800 && code_point <= 0xDBFF && pos + 1 < str.size() &&
+        str[pos + 1] >= 0xDC00 && str[pos + 1] <= 0xDFFF) {
+      code_point = 0x10000 + ((code_point - 0xD800) << 10) + (str[pos + 1] - 0xDC00);
+      ++pos;
+    } else if (code_point >= 0xD800 && code_point <= 0xDFFF) {
+      code_point = kReplacementChar;
+    }
+    written += EncodeUtf8(code_point, out + written);
+  }
+  res.Resize(written);
+  return res;
+}
+
+String Utf32ToUtf8(std::u32string_view str) {
+  String res;
+  res.Resize(str.size() * 4);
+  char* out = res.Data();
+  size_t written = 0;
+  for (char32_t code_point : str) {
+    written += EncodeUtf8(IsScalarValue(code_point) ? code_point : kReplacementChar, out + written);
+  }
+  res.Resize(written);
+  return res;
+}
+
+char32_t FoldCase(char32_t code_point) {
+  char32_t cp = code_point;
+  if (cp < 0x80) {
+    return cp >= 'A' && cp <= 'Z' ? cp + 32 : cp;
+  }
+  if (cp == 0xB5) {
+    return 0x3BC;
+  }
+  if ((cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) || (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2) ||
+      (cp >= 0x410 && cp <= 0x42F) || (cp >= 0xFF21 && cp <= 0xFF3A)) {
+    return cp + 32;
+  }
+  if (cp >= 0x400 && cp <= 0x40F) {
+    return cp + 80;
+  }
+  if (cp >= 0x531 && cp <= 0x556) {
+    return cp + 48;
+  }
+  // Ranges where upper and lower case letters alternate.
+  bool even_upper = (cp >= 0x100 && cp <= 0x12F) || (cp >= 0x132 && cp <= 0x137) ||
+                    (cp >= 0x14A && cp <= 0x177) || (cp >= 0x460 && cp <= 0x481) ||
+                    (cp >= 0x48A && cp <= 0x4BF) || (cp >= 0x4D0 && cp <= 0x52F) ||
+                    (cp >= 0x1E00 && cp <= 0x1E95) || (cp >= 0x1EA0 && cp <= 0x1EFF);
+  if (even_upper) {
+    return cp | 1;
+  }
+  bool odd_upper = (cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E) ||
+                   (cp >= 0x4C1 && cp <= 0x4CE);
+  if (odd_upper) {
+    return cp % 2 == 1 ? cp + 1 : cp;
+  }
+  switch (cp) {
+    case 0x178:
+      return 0xFF;
+    case 0x17F:
+      return 's';
+    case 0x386:
+      return 0x3AC;
+    case 0x388:
+    case 0x389:
+    case 0x38A:
+      return cp + 37;
+    case 0x38C:
+      return 0x3CC;
+    case 0x38E:
+    case 0x38F:
+      return cp + 63;
+    case 0x3C2:
+      return 0x3C3;
+    case 0x4C0:
+      return 0x4CF;
+    default:
+      return cp;
+  }
+}
+
+String FoldCase(StringView str) {
+  String res;
+  res.Resize(str.Size());
+  char* out = res.Data();
+  const auto* data = reinterpret_cast<const unsigned char*>(str.Data());
+  size_t size = str.Size();
+  size_t written = 0;
+  size_t pos = 0;
+  while (pos < size) {
+    size_t ascii = AsciiPrefix(data + pos, size - pos);
+    for (size_t end = pos + ascii; pos < end; ++pos) {
+      unsigned char sym = data[pos];
+      out[written++] = static_cast<char>(sym >= 'A' && sym <= 'Z' ? sym + 32 : sym);
+    }
+    if (pos == size) {
+      break;
+    }
+    char32_t code_point;
+    size_t length = DecodeUtf8(data + pos, size - pos, code_point);
+    if (length == 0) {
+      // Malformed bytes are kept, not replaced: folding must not change them.
+      out[written++] = static_cast<char>(data[pos++]);
+      continue;
+    }
+    // Every folding above keeps the encoded length or shortens it.
+    written += EncodeUtf8(FoldCase(code_point), out + written);
+    pos += length;
+  }
+  res.Resize(written);
+  return res;
+}
+
+CodePointRange::Iterator::Iterator(const char* cur, const char* end) : cur_(cur), end_(end) {
+  Decode();
+}
+
+void CodePointRange::Iterator::Decode() {
+  if (cur_ == end_) {
+    length_ = 0;
+    return;
+  }
+  length_ = DecodeUtf8(reinterpret_cast<const unsigned char*>(cur_), end_ - cur_, code_point_);
+  if (length_ == 0) {
+    code_point_ = kReplacementChar;
+    length_ = 1;
+  }
+}
+
+CodePointRange::Iterator& CodePointRange::Iterator::operator++() {
+  cur_ += length_;
+  Decode();
+  return *this;
+}
+
+CodePointRange::Iterator CodePointRange::Iterator::operator++(int) {
+  Iterator copy = *this;
+  ++*this;
+  return copy;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "string.hpp"
+
+// UTF-8 helpers over String and StringView. Malformed input (overlong forms,
+// surrogates, code points past U+10FFFF, truncated sequences) decodes to
+// U+FFFD one byte at a time, the way most decoders resynchronize.
+
+const char32_t kReplacementChar = 0xFFFD;
+
+bool IsValidUtf8(StringView str);
+
+size_t CountCodePoints(StringView str);
+
+std::u16string Utf8ToUtf16(StringView str);
+
+std::u32string Utf8ToUtf32(StringView str);
+
+String Utf16ToUtf8(std::u16string_view str);
+
+String Utf32ToUtf8(std::u32string_view str);
+
+// Simple case folding for Latin, Greek, Cyrillic and Armenian letters; other
+// code points are copied as is.
+String FoldCase(StringView str);
+
+char32_t FoldCase(char32_t code_point);
+
+// Lazy sequence of the code points of a UTF-8 string.
+class CodePointRange {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = char32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const char32_t*;
+    using reference = const char32_t&;
+
+    Iterator() = default;
+
+    const char32_t& operator*() const { return code_point_; }
+
+    Iterator& operator++();
+
+    Iterator operator++(int);
+
+    // Where the current code point starts in the source.
+    const char* Position() const { return cur_; }
+
+    bool operator==(const Iterator& other) const { return cur_ == other.cur_; }
+
+    bool operator!=(const Iterator& other) const { return cur_ != other.cur_; }
+
+   private:
+    friend class CodePointRange;
+
+    Iterator(const char* cur, const char* end);
+
+    void Decode();
+
+    const char* cur_ = nullptr;
+    const char* end_ = nullptr;
+    size_t length_ = 0;
+    char32_t code_point_ = 0;
+  };
+
+  explicit CodePointRange(StringView source) : source_(source) {}
+
+  Iterator begin() const { return Iterator(source_.begin(), source_.end()); }
+
+  Iterator end() const { return Iterator(source_.end(), source_.end()); }
+
+ private:
+  StringView source_;
+};
+
+inline CodePointRange CodePoints(StringView str) { return CodePointRange(str); }
\ No newline at end of file
@@ -0,0 +1,100 @@
+// UTF-8 benchmark: repeats short samples of several scripts into 16 KiB
+// texts and times IsValidUtf8, Utf8ToUtf16 and Utf8ToUtf32 on each, next to
+// a byte-at-a-time decoder as the baseline, printing MB/s of UTF-8 input.
+// The texts are small enough to stay in cache and for the allocator to hand
+// the conversions the same buffers back, so the kernels dominate.
+//
+//   g++ -std=c++20 -O2 utf8_bench.cpp utf8.cpp string.cpp
+//   ./a.out
+
+#include "utf8.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const size_t kTextSize = size_t{16} << 10;
+const int kRuns = 5;
+const int kRepeats = 2000;
+
+struct Sample {
+  const char* name;
+  const char* text;
+};
+
+const Sample kSamples[] = {
+    {"ascii", "The quick brown fox jumps over the lazy dog, 0123456789 times. "},
+    {"latin", "Příliš žluťoučký kůň úpěl ďábelské ódy; Größe, façade, naïve. "},
+    {"cyrillic", "Съешь же ещё этих мягких французских булок, да выпей чаю. "},
+    {"cjk", "我能吞下玻璃而不伤身体。いろはにほへと ちりぬるを。"},
+    {"mixed", "Hello, мир! 你好, world — ½ € ≠ ∞. Ελληνικά και English. "},
+    {"emoji", "Good 👍 night 🌙, see you 🙂 soon 🚀! "},
+};
+
+std::string Repeat(const char* sample) {
+  std::string text;
+  while (text.size() < kTextSize) {
+    text += sample;
+  }
+  return text;
+}
+
+// The decoder the library had before any vector kernels, without error
+// handling: well-formed input only.
+size_t NaiveUtf8ToUtf32(const std::string& text, char32_t* out) {
+  const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+  size_t written = 0;
+  for (size_t pos = 0; pos < text.size();) {
+    unsigned char lead = data[pos];
+    if (lead < 0x80) {
+      out[written++] = lead;
+      pos += 1;
+    } else if (lead < 0xE0) {
+      out[written++] = (char32_t{lead} & 0x1F) << 6 | (data[pos + 1] & 0x3F);
+      pos += 2;
+    } else if (lead < 0xF0) {
+      out[written++] = (char32_t{lead} & 0x0F) << 12 | (data[pos + 1] & 0x3F) << 6 | (data[pos + 2] & 0x3F);
+      pos += 3;
+    } else {
+      out[written++] = (char32_t{lead} & 0x07) << 18 | (data[pos + 1] & 0x3F) << 12 | (data[pos + 2] & 0x3F) << 6 |
+                       (data[pos + 3] & 0x3F);
+      pos += 4;
+    }
+  }
+  return written;
+}
+
+template <typename Func>
+double Measure(const std::string& text, Func&& func) {
+  double best = 0;
+  for (int run = 0; run < kRuns; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepeats; ++i) {
+      func();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double rate = text.size() * kRepeats / elapsed.count() / 1e6;
+    best = rate > best ? rate : best;
+  }
+  return best;
+}
+
+}  // namespace
+
+int main() {
+  printf("%-9s %10s %10s %10s %10s\n", "text", "valid", "to utf16", "to utf32", "naive32");
+  size_t sink = 0;
+  for (const Sample& sample : kSamples) {
+    std::string text = Repeat(sample.text);
+    std::u32string scratch(text.size(), U'\0');
+    StringView view(text.data(), text.size());
+    double valid = Measure(text, [&] { sink += IsValidUtf8(view); });
+    double utf16 = Measure(text, [&] { sink += Utf8ToUtf16(view).size(); });
+    double utf32 = Measure(text, [&] { sink += Utf8ToUtf32(view).size(); });
+    double naive = Measure(text, [&] { sink += NaiveUtf8ToUtf32(text, scratch.data()); });
+    printf("%-9s %10.0f %10.0f %10.0f %10.0f\n", sample.name, valid, utf16, utf32, naive);
+  }
+  return sink == 0;
+}
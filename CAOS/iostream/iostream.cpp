@@ -21,7 +21,38 @@ void ostream::put(char sym) {
     }
 }
 
+void ostream::write_bytes(const char* data, size_t count) {
+    if (count >= static_cast<size_t>(size_)) {
+        flush();
+        while (count > 0) {
+            ssize_t wrote = write(1, data, count);
+            if (wrote == -1) {
+                fail_ = true;
+                return;
+            }
+            data += wrote;
+            count -= wrote;
+        }
+        return;
+    }
+
+    while (count > 0) {
+        size_t part = std::min(count, static_cast<size_t>(size_ - end_));
+        std::memcpy(buf_ + end_, data, part);
+        end_ += part;
+        data += part;
+        count -= part;
+        if (end_ == size_) {
+            flush();
+        }
+    }
+}
+
 ostream& ostream::operator<<(bool b) {
+    if (mode_ != stream_mode::text) {
+        put(b ? 1 : 0);
+        return *this;
+    }
     put(b ? '1' : '0');
     return *this;
 }
@@ -93,8 +124,68 @@ char istream::peek() {
     return buf_[end_];
 }
 
+bool istream::read_bytes(char* data, size_t count) {
+    while (count > 0) {
+        size_t available = (end_ < readed_) ? readed_ - end_ : 0;
+        if (available == 0) {
+            if (count >= static_cast<size_t>(size_)) {
+                ssize_t got = read(0, data, count);
+                if (got <= 0) {
+                    fail_ = true;
+                    return false;
+                }
+                data += got;
+                count -= got;
+                continue;
+            }
+            readed_ = read(0, buf_, size_);
+            end_ = 0;
+            if (readed_ <= 0) {
+                readed_ = 0;
+                fail_ = true;
+                return false;
+            }
+            continue;
+        }
+
+        size_t part = std::min(count, available);
+        std::memcpy(data, buf_ + end_, part);
+        end_ += part;
+        data += part;
+        count -= part;
+    }
+
+    if (end_ == readed_) {
+        end_ = size_;
+        readed_ = 1;
+    }
+    return true;
+}
+
+bool istream::fill() {
+    if (end_ < readed_) {
+        return true;
+    }
+    readed_ = read(0, buf_, size_);
+    end_ = 0;
+    if (readed_ <= 0) {
+        readed_ = 0;
+        return false;
+    }
+    return true;
+}
+
 template <typename T>
 T istream::GetInt() {
+    if constexpr (std::is_integral<T>::value) {
+        if (mode_ == stream_mode::binary) {
+            return GetFixed<T>();
+        }
+        if (mode_ == stream_mode::varint) {
+            return GetVarint<T>();
+        }
+    }
+
     u_int64_t res = 0;
     char cur = get();
     for (; cur == ' ' || cur == '\n'; cur = get()) {
@@ -131,6 +222,10 @@ T istream::GetInt() {
 
 template <typename T>
 T istream::GetFloat() {
+    if (mode_ != stream_mode::text) {
+        return GetFixed<T>();
+    }
+
     T res = GetInt<T>();
 
     if (fail_) {
@@ -156,12 +251,22 @@ T istream::GetFloat() {
 
 istream& istream::operator>>(bool& b) {
     cout.flush();
+    if (mode_ != stream_mode::text) {
+        char byte = 0;
+        read_bytes(&byte, 1);
+        b = (byte != 0);
+        return *this;
+    }
     b = (GetInt<int>() == 0) ? false : true;
     return *this;
 }
 
 istream& istream::operator>>(char& sym) {
     cout.flush();
+    if (mode_ != stream_mode::text) {
+        read_bytes(&sym, 1);
+        return *this;
+    }
     for (sym = get(); sym == ' ' || sym == '\n'; sym = get()) {
     }
     return *this;
@@ -1,11 +1,22 @@
 #pragma once
 
 #include <unistd.h>
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <limits>
 #include <type_traits>
 #include <iostream>
 
 namespace stdlike {
 
+enum class stream_mode {
+  text = 1,
+  binary = 2,
+  varint = 3
+};
+
   class ostream {
     public:
 
@@ -15,6 +26,13 @@ namespace stdlike {
 
       bool fail() const { return fail_; }
 
+      stream_mode mode() const { return mode_; }
+
+      void set_mode(stream_mode mode) { mode_ = mode; }
+
+      template <typename T>
+      ostream& write_span(const T* data, size_t count);
+
       ostream& operator<<(bool b);
       ostream& operator<<(char sym);
       ostream& operator<<(const char* str);
@@ -34,6 +52,14 @@ namespace stdlike {
 
     private:
 
+    void write_bytes(const char* data, size_t count);
+
+    template <typename T>
+    void put_fixed(T num);
+
+    template <typename T>
+    void put_varint(T num);
+
     static const int size_ = 256; 
 
     char buf_[size_];
@@ -41,6 +67,8 @@ namespace stdlike {
     int end_ = 0;
 
     bool fail_ = false;
+
+    stream_mode mode_ = stream_mode::text;
   };
 
 class istream {
@@ -51,6 +79,18 @@ class istream {
 
     bool fail() const { return fail_; }
 
+    stream_mode mode() const { return mode_; }
+
+    void set_mode(stream_mode mode) { mode_ = mode; }
+
+    template <typename T>
+    istream& read_span(T* data, size_t count);
+
+    // Skips whitespace and hands the next word to sink(const char*, size_t)
+    // straight from the buffer, in as many pieces as the word spans.
+    template <typename Sink>
+    istream& read_word(Sink sink);
+
     istream& operator>>(bool& b);
     istream& operator>>(char& sym);
     istream& operator>>(short& num);
@@ -74,6 +114,16 @@ class istream {
     template<typename T>
     T GetFloat();
 
+    template<typename T>
+    T GetFixed();
+
+    template<typename T>
+    T GetVarint();
+
+    bool read_bytes(char* data, size_t count);
+
+    bool fill();
+
     static const int size_ = 256;
 
     char buf_[size_];
@@ -83,10 +133,165 @@ class istream {
     int end_ = size_;
 
     bool fail_ = false;
+
+    stream_mode mode_ = stream_mode::text;
   };
 
+extern istream cin;
+extern ostream cout;
+
+// Bytes of T that carry its value in binary mode. The x87 80-bit long double
+// is padded to 12 or 16 bytes; only its 10 significant bytes are streamed.
+template <typename T>
+constexpr size_t fixed_width() {
+    if constexpr (std::is_floating_point<T>::value && std::numeric_limits<T>::digits == 64) {
+        return 10;
+    } else {
+        return sizeof(T);
+    }
+}
+
+// Fixed-width values are always written in little-endian byte order,
+// varint mode encodes integers as ULEB128 (unsigned) or SLEB128 (signed).
+template <typename T>
+void ostream::put_fixed(T num) {
+    constexpr size_t width = fixed_width<T>();
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &num, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+        for (size_t i = 0; i < width / 2; ++i) {
+            std::swap(bytes[i], bytes[width - 1 - i]);
+        }
+    }
+    write_bytes(bytes, width);
+}
+
+template <typename T>
+void ostream::put_varint(T num) {
+    bool more = true;
+    while (more) {
+        unsigned char byte = static_cast<unsigned char>(num & 0x7f);
+        num >>= 7;
+        if constexpr (std::is_signed<T>::value) {
+            more = !((num == 0 && (byte & 0x40) == 0) || (num == -1 && (byte & 0x40) != 0));
+        } else {
+            more = (num != 0);
+        }
+        if (more) {
+            byte |= 0x80;
+        }
+        put(static_cast<char>(byte));
+    }
+}
+
+template <typename T>
+ostream& ostream::write_span(const T* data, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "write_span requires trivially copyable type");
+    if constexpr ((std::endian::native == std::endian::little && fixed_width<T>() == sizeof(T)) ||
+                  sizeof(T) == 1) {
+        write_bytes(reinterpret_cast<const char*>(data), count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            put_fixed(data[i]);
+        }
+    }
+    return *this;
+}
+
+template <typename T>
+T istream::GetFixed() {
+    constexpr size_t width = fixed_width<T>();
+    char bytes[sizeof(T)] = {};
+    if (!read_bytes(bytes, width)) {
+        return T();
+    }
+    if constexpr (std::endian::native == std::endian::big) {
+        for (size_t i = 0; i < width / 2; ++i) {
+            std::swap(bytes[i], bytes[width - 1 - i]);
+        }
+    }
+    T res;
+    std::memcpy(&res, bytes, sizeof(T));
+    return res;
+}
+
+template <typename T>
+T istream::GetVarint() {
+    using U = std::make_unsigned_t<T>;
+    U res = 0;
+    size_t shift = 0;
+    char byte = 0;
+    do {
+        if (!read_bytes(&byte, 1)) {
+            return T();
+        }
+        if (shift < sizeof(T) * 8) {
+            res |= static_cast<U>(static_cast<unsigned char>(byte) & 0x7f) << shift;
+        }
+        shift += 7;
+    } while ((byte & 0x80) != 0);
+
+    if constexpr (std::is_signed<T>::value) {
+        if (shift < sizeof(T) * 8 && (byte & 0x40) != 0) {
+            res |= ~static_cast<U>(0) << shift;
+        }
+    }
+    return static_cast<T>(res);
+}
+
+template <typename Sink>
+istream& istream::read_word(Sink sink) {
+    cout.flush();
+    while (fill() && std::isspace(static_cast<unsigned char>(buf_[end_]))) {
+        ++end_;
+    }
+    bool got = false;
+    while (fill()) {
+        int start = end_;
+        while (end_ < readed_ && !std::isspace(static_cast<unsigned char>(buf_[end_]))) {
+            ++end_;
+        }
+        if (end_ > start) {
+            sink(buf_ + start, static_cast<size_t>(end_ - start));
+            got = true;
+        }
+        if (end_ < readed_) {
+            break;
+        }
+    }
+    fail_ = !got;
+    if (end_ == readed_) {
+        end_ = size_;
+        readed_ = 1;
+    }
+    return *this;
+}
+
+template <typename T>
+istream& istream::read_span(T* data, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "read_span requires trivially copyable type");
+    if constexpr ((std::endian::native == std::endian::little && fixed_width<T>() == sizeof(T)) ||
+                  sizeof(T) == 1) {
+        read_bytes(reinterpret_cast<char*>(data), count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < count && !fail_; ++i) {
+            data[i] = GetFixed<T>();
+        }
+    }
+    return *this;
+}
+
 template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type>
 ostream& ostream::operator<<(T num) {
+    if (mode_ == stream_mode::binary) {
+        put_fixed(num);
+        return *this;
+    }
+    if (mode_ == stream_mode::varint) {
+        put_varint(num);
+        return *this;
+    }
+
     std::make_unsigned_t<T> abs;
     if (num < 0) {
         put('-');
@@ -99,6 +304,15 @@ ostream& ostream::operator<<(T num) {
 
 template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, int>::type>
 ostream& ostream::operator<<(T num) {
+    if (mode_ == stream_mode::binary) {
+        put_fixed(num);
+        return *this;
+    }
+    if (mode_ == stream_mode::varint) {
+        put_varint(num);
+        return *this;
+    }
+
     char str[20];
     char* cur = str;
 
@@ -116,6 +330,11 @@ ostream& ostream::operator<<(T num) {
 
 template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type>
 ostream& ostream::operator<<(T num) {
+    if (mode_ != stream_mode::text) {
+        put_fixed(num);
+        return *this;
+    }
+
     if (num < 0) {
         put('-');
         num = -num;
@@ -139,7 +358,4 @@ ostream& ostream::operator<<(T num) {
     return *this;
 }
 
-extern istream cin;
-extern ostream cout;
-
 }  // namespace stdlike
\ No newline at end of file
@@ -0,0 +1,421 @@
+#include "dir_index.hpp"
+#include <sys/inotify.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+namespace stdlike {
+
+namespace {
+
+const uint32_t kIndexMagic = 0x58494453;
+const uint32_t kIndexVersion = 1;
+
+const uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB |
+                            IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE |
+                            IN_MOVE_SELF | IN_DELETE_SELF;
+
+bool read_record(int dir_fd, const char* name, index_record& rec, bool follow = false) {
+    struct statx stx;
+    int flags = follow ? 0 : AT_SYMLINK_NOFOLLOW;
+    if (statx(dir_fd, name, flags, STATX_TYPE | STATX_INO | STATX_SIZE | STATX_CTIME, &stx) != 0) {
+        return false;
+    }
+    rec.inode = stx.stx_ino;
+    rec.size = stx.stx_size;
+    rec.write_time = stx.stx_ctime.tv_sec;
+    rec.is_directory = S_ISDIR(stx.stx_mode);
+    return true;
+}
+
+std::string join(const std::string& dir, const char* name) {
+    std::string path;
+    path.reserve(dir.size() + strlen(name) + 1);
+    path = dir;
+    if (path.empty() || path.back() != '/') {
+        path += '/';
+    }
+    path += name;
+    return path;
+}
+
+// Smallest key that sorts after every path inside the subtree of path.
+std::string subtree_end(const std::string& path) {
+    return path + '\x01';
+}
+
+template <typename T>
+void write_value(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_value(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+}  // namespace
+
+bool path_less::operator()(const std::string& first, const std::string& second) const {
+    size_t len = std::min(first.size(), second.size());
+    for (size_t i = 0; i < len; ++i) {
+        if (first[i] != second[i]) {
+            unsigned char a = (first[i] == '/') ? 0 : first[i];
+            unsigned char b = (second[i] == '/') ? 0 : second[i];
+            return a < b;
+        }
+    }
+    return first.size() < second.size();
+}
+
+directory_index::directory_index(const char* root) : root_(root) {
+    while (root_.size() > 1 && root_.back() == '/') {
+        root_.pop_back();
+    }
+}
+
+directory_index::~directory_index() {
+    if (inotify_fd_ != -1) {
+        close(inotify_fd_);
+    }
+}
+
+void directory_index::build() {
+    time_t start = time(nullptr);
+    records_.clear();
+
+    index_record root;
+    if (!read_record(AT_FDCWD, root_.c_str(), root, true)) {
+        return;
+    }
+    records_[root_] = root;
+
+    for (auto it = recursive_directory_iterator(root_.c_str()); it != end(it); ++it) {
+        index_record rec;
+        if (read_record(AT_FDCWD, it->path(), rec)) {
+            records_[it->path()] = rec;
+        }
+    }
+    scan_time_ = start;
+}
+
+void directory_index::update(const change_callback& on_change, bool verify_files) {
+    time_t start = time(nullptr);
+
+    index_record root;
+    if (!read_record(AT_FDCWD, root_.c_str(), root, true)) {
+        erase_subtree(root_, on_change);
+        return;
+    }
+    visit(root_, root, verify_files, on_change);
+    scan_time_ = start;
+}
+
+void directory_index::visit(const std::string& path, const index_record& now, bool verify_files,
+                            const change_callback& on_change) {
+    auto it = records_.find(path);
+    // A directory written during the second the previous scan started may have
+    // changed after it was listed, so it is relisted as well.
+    bool changed = (it == records_.end() || it->second.inode != now.inode ||
+                    it->second.write_time != now.write_time || now.write_time >= scan_time_);
+    records_[path] = now;
+
+    if (changed) {
+        relist(path, verify_files, on_change);
+        return;
+    }
+
+    for (const auto& child : children(path)) {
+        const index_record& old = records_[child];
+        if (!old.is_directory && !verify_files) {
+            continue;
+        }
+
+        index_record rec;
+        if (!read_record(AT_FDCWD, child.c_str(), rec)) {
+            erase_subtree(child, on_change);
+            continue;
+        }
+        if (rec.is_directory) {
+            visit(child, rec, verify_files, on_change);
+        } else if (!(rec == old)) {
+            records_[child] = rec;
+            on_change(index_change::modified, child);
+        }
+    }
+}
+
+void directory_index::relist(const std::string& path, bool verify_files,
+                             const change_callback& on_change) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    add_watch(path);
+
+    std::unordered_set<std::string> seen;
+    for (auto next_file = readdir(dir); next_file != nullptr; next_file = readdir(dir)) {
+        if (next_file->d_name[0] == '.') {
+            continue;
+        }
+
+        index_record rec;
+        if (!read_record(dirfd(dir), next_file->d_name, rec)) {
+            continue;
+        }
+
+        std::string child = join(path, next_file->d_name);
+        auto old = records_.find(child);
+        if (old != records_.end() && old->second.is_directory != rec.is_directory) {
+            erase_subtree(child, on_change);
+            old = records_.end();
+        }
+
+        if (old == records_.end()) {
+            records_[child] = rec;
+            on_change(index_change::added, child);
+            if (rec.is_directory) {
+                relist(child, verify_files, on_change);
+            }
+        } else if (rec.is_directory) {
+            visit(child, rec, verify_files, on_change);
+        } else if (!(rec == old->second)) {
+            old->second = rec;
+            on_change(index_change::modified, child);
+        }
+        seen.insert(std::move(child));
+    }
+    closedir(dir);
+
+    for (const auto& child : children(path)) {
+        if (seen.count(child) == 0) {
+            erase_subtree(child, on_change);
+        }
+    }
+}
+
+void directory_index::erase_subtree(const std::string& path, const change_callback& on_change) {
+    auto first = records_.find(path);
+    if (first == records_.end()) {
+        return;
+    }
+    auto last = records_.lower_bound(subtree_end(path));
+    for (auto it = first; it != last; ++it) {
+        on_change(index_change::removed, it->first);
+    }
+    records_.erase(first, last);
+}
+
+std::vector<std::string> directory_index::children(const std::string& path) const {
+    std::vector<std::string> res;
+    std::string prefix = join(path, "");
+    auto it = records_.lower_bound(prefix);
+    while (it != records_.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        res.push_back(it->first);
+        it = records_.lower_bound(subtree_end(it->first));
+    }
+    return res;
+}
+
+const index_record* directory_index::find(const std::string& path) const {
+    auto it = records_.find(path);
+    return (it == records_.end()) ? nullptr : &it->second;
+}
+
+bool directory_index::save(const char* index_path) const {
+    std::ofstream out(index_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    write_value(out, kIndexMagic);
+    write_value(out, kIndexVersion);
+    write_value(out, static_cast<int64_t>(scan_time_));
+    write_value(out, static_cast<uint64_t>(root_.size()));
+    out.write(root_.data(), root_.size());
+    write_value(out, static_cast<uint64_t>(records_.size()));
+
+    for (const auto& [path, rec] : records_) {
+        write_value(out, static_cast<uint64_t>(path.size()));
+        out.write(path.data(), path.size());
+        write_value(out, static_cast<uint64_t>(rec.inode));
+        write_value(out, static_cast<uint64_t>(rec.size));
+        write_value(out, static_cast<int64_t>(rec.write_time));
+        write_value(out, static_cast<uint8_t>(rec.is_directory));
+    }
+    return static_cast<bool>(out);
+}
+
+bool directory_index::load(const char* index_path) {
+    std::ifstream in(index_path, std::ios::binary);
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    int64_t scan_time = 0;
+    uint64_t len = 0;
+    if (!read_value(in, magic) || magic != kIndexMagic ||
+        !read_value(in, version) || version != kIndexVersion ||
+        !read_value(in, scan_time) || !read_value(in, len)) {
+        return false;
+    }
+
+    std::string root(len, '\0');
+    uint64_t count = 0;
+    if (!in.read(root.data(), len) || root != root_ || !read_value(in, count)) {
+        return false;
+    }
+
+    std::map<std::string, index_record, path_less> records;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t inode = 0;
+        uint64_t size = 0;
+        int64_t write_time = 0;
+        uint8_t is_directory = 0;
+        if (!read_value(in, len)) {
+            return false;
+        }
+        std::string path(len, '\0');
+        if (!in.read(path.data(), len) || !read_value(in, inode) || !read_value(in, size) ||
+            !read_value(in, write_time) || !read_value(in, is_directory)) {
+            return false;
+        }
+        records.emplace_hint(records.end(), std::move(path),
+                             index_record{inode, size, static_cast<time_t>(write_time), is_directory != 0});
+    }
+
+    records_ = std::move(records);
+    scan_time_ = scan_time;
+    return true;
+}
+
+bool directory_index::watch() {
+    if (inotify_fd_ == -1) {
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ == -1) {
+            return false;
+        }
+    }
+    for (const auto& [path, rec] : records_) {
+        if (rec.is_directory) {
+            add_watch(path);
+        }
+    }
+    return true;
+}
+
+void directory_index::add_watch(const std::string& path) {
+    if (inotify_fd_ == -1) {
+        return;
+    }
+    int wd = inotify_add_watch(inotify_fd_, path.c_str(), kWatchMask);
+    if (wd != -1) {
+        watches_[wd] = path;
+    }
+}
+
+void directory_index::drop_watches(const std::string& path) {
+    std::string prefix = join(path, "");
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        if (it->second == path || it->second.compare(0, prefix.size(), prefix) == 0) {
+            inotify_rm_watch(inotify_fd_, it->first);
+            it = watches_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void directory_index::self_changed(std::string path, const change_callback& on_change) {
+    // A rename inside the tree is reported to the parents first, and relisting
+    // the new path has already rekeyed the watch to it.
+    index_record rec;
+    auto old = records_.find(path);
+    if (old != records_.end() && read_record(AT_FDCWD, path.c_str(), rec, path == root_) &&
+        rec.is_directory && rec.inode == old->second.inode) {
+        return;
+    }
+
+    // The directory left the tree or is gone. Watches below it would report
+    // events under paths that no longer lead there.
+    drop_watches(path);
+    // Its parent's events normally drop it from the index too; the root has
+    // no watched parent, so fall back to a rescan.
+    if (old != records_.end()) {
+        update(on_change);
+    }
+}
+
+void directory_index::poll(const change_callback& on_change) {
+    if (inotify_fd_ == -1) {
+        return;
+    }
+
+    alignas(inotify_event) char buf[64 * 1024];
+    while (true) {
+        ssize_t got = read(inotify_fd_, buf, sizeof(buf));
+        if (got <= 0) {
+            return;
+        }
+
+        for (char* cur = buf; cur < buf + got;) {
+            auto event = reinterpret_cast<const inotify_event*>(cur);
+            cur += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                update(on_change);
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches_.erase(event->wd);
+                continue;
+            }
+
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end()) {
+                continue;
+            }
+            if (event->mask & (IN_MOVE_SELF | IN_DELETE_SELF)) {
+                self_changed(watch->second, on_change);
+                continue;
+            }
+            if (event->len == 0 || event->name[0] == '.') {
+                continue;
+            }
+            std::string dir = watch->second;
+            std::string path = join(dir, event->name);
+
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                erase_subtree(path, on_change);
+            } else {
+                index_record rec;
+                if (!read_record(AT_FDCWD, path.c_str(), rec)) {
+                    continue;
+                }
+                auto old = records_.find(path);
+                // A directory renamed over another one replaces its subtree.
+                if (old != records_.end() && (old->second.is_directory != rec.is_directory ||
+                                              (rec.is_directory && old->second.inode != rec.inode))) {
+                    erase_subtree(path, on_change);
+                    old = records_.end();
+                }
+                if (old == records_.end()) {
+                    records_[path] = rec;
+                    on_change(index_change::added, path);
+                    if (rec.is_directory) {
+                        relist(path, false, on_change);
+                    }
+                } else if (!rec.is_directory && !(rec == old->second)) {
+                    old->second = rec;
+                    on_change(index_change::modified, path);
+                }
+            }
+
+            index_record dir_rec;
+            if (read_record(AT_FDCWD, dir.c_str(), dir_rec) && records_.count(dir) != 0) {
+                records_[dir] = dir_rec;
+            }
+        }
+    }
+}
+
+}  // namespace stdlike
\ No newline at end of file
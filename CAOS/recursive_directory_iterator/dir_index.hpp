@@ -0,0 +1,96 @@
+#pragma once
+
+#include <sys/stat.h>
+#include <time.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rec_dir_it.hpp"
+
+namespace stdlike {
+
+enum class index_change {
+  added = 1,
+  removed = 2,
+  modified = 3
+};
+
+struct index_record {
+  ino_t inode = 0;
+  size_t size = 0;
+  time_t write_time = 0;
+  bool is_directory = false;
+
+  bool operator==(const index_record& other) const = default;
+};
+
+// Orders paths component by component, so that a directory is immediately
+// followed by its whole subtree.
+struct path_less {
+  bool operator()(const std::string& first, const std::string& second) const;
+};
+
+// Persistent (path, inode, size, write time) index of a directory tree.
+// update() relists only the directories whose write time or inode changed
+// since the previous scan and walks through the others using the stored
+// children. Files rewritten in place inside an unchanged directory are only
+// noticed with verify_files or through watch()/poll().
+class directory_index {
+ public:
+  using change_callback = std::function<void(index_change, const std::string&)>;
+
+  directory_index(const char* root);
+
+  directory_index(const directory_index&) = delete;
+
+  directory_index& operator=(const directory_index&) = delete;
+
+  ~directory_index();
+
+  void build();
+
+  void update(const change_callback& on_change, bool verify_files = false);
+
+  bool load(const char* index_path);
+
+  bool save(const char* index_path) const;
+
+  // Starts inotify watches on every indexed directory, poll() then turns
+  // pending events into changes without rescanning. A directory moved out of
+  // the tree or deleted loses its watches; if that is the root, poll() falls
+  // back to update().
+  bool watch();
+
+  void poll(const change_callback& on_change);
+
+  const index_record* find(const std::string& path) const;
+
+  size_t size() const { return records_.size(); }
+
+ private:
+  void visit(const std::string& path, const index_record& now, bool verify_files,
+             const change_callback& on_change);
+
+  void relist(const std::string& path, bool verify_files, const change_callback& on_change);
+
+  void erase_subtree(const std::string& path, const change_callback& on_change);
+
+  std::vector<std::string> children(const std::string& path) const;
+
+  void add_watch(const std::string& path);
+
+  void drop_watches(const std::string& path);
+
+  void self_changed(std::string path, const change_callback& on_change);
+
+  std::string root_;
+  std::map<std::string, index_record, path_less> records_;
+  time_t scan_time_ = 0;
+  int inotify_fd_ = -1;
+  std::unordered_map<int, std::string> watches_;
+};
+
+}  // namespace stdlike
\ No newline at end of file
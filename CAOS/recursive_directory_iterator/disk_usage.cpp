@@ -0,0 +1,398 @@
+#include "disk_usage.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <set>
+#include <thread>
+#include <utility>
+
+namespace stdlike {
+
+namespace {
+
+const uint64_t kPrime1 = 11400714785074694791ULL;
+const uint64_t kPrime2 = 14029467366897019727ULL;
+const uint64_t kPrime3 = 1609587929392839161ULL;
+const uint64_t kPrime4 = 9650029242287828579ULL;
+const uint64_t kPrime5 = 2870177450012600261ULL;
+
+const size_t kReadSize = 1 << 20;
+const size_t kReadAlign = 4096;
+
+uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t read64(const unsigned char* ptr) {
+    uint64_t res;
+    std::memcpy(&res, ptr, sizeof(res));
+    return res;
+}
+
+uint32_t read32(const unsigned char* ptr) {
+    uint32_t res;
+    std::memcpy(&res, ptr, sizeof(res));
+    return res;
+}
+
+uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+uint64_t merge_round(uint64_t acc, uint64_t val) {
+    acc ^= round(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+
+struct hash_job {
+    size_t size;
+    std::string path;
+};
+
+struct hash_result {
+    size_t size;
+    uint64_t hash;
+    std::string path;
+};
+
+template <typename T>
+class bounded_queue {
+ public:
+    explicit bounded_queue(size_t capacity) : capacity_(capacity) {}
+
+    void push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return queue_.size() < capacity_; });
+        queue_.push(std::move(value));
+        not_empty_.notify_one();
+    }
+
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !queue_.empty() || closed_; });
+        if (queue_.empty()) {
+            return false;
+        }
+        value = std::move(queue_.front());
+        queue_.pop();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+    }
+
+ private:
+    size_t capacity_;
+    std::queue<T> queue_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+using read_buffer = std::unique_ptr<char, decltype(&std::free)>;
+
+read_buffer make_read_buffer() {
+    read_buffer buf(static_cast<char*>(std::aligned_alloc(kReadAlign, kReadSize)), &std::free);
+    if (buf == nullptr) {
+        throw std::bad_alloc();
+    }
+    return buf;
+}
+
+// Reads until buf is full or the file ends, returns the bytes read or -1.
+ssize_t read_full(int fd, char* buf, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t got = read(fd, buf + done, size - done);
+        if (got == -1) {
+            return -1;
+        }
+        if (got == 0) {
+            break;
+        }
+        done += got;
+    }
+    return done;
+}
+
+bool hash_file(const char* path, char* buf, uint64_t& hash) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    xxhash64 state;
+    ssize_t got;
+    while ((got = read(fd, buf, kReadSize)) > 0) {
+        state.update(buf, got);
+    }
+    close(fd);
+
+    hash = state.digest();
+    return got == 0;
+}
+
+void hash_worker(bounded_queue<hash_job>& jobs, std::vector<hash_result>& results, char* buf) {
+    hash_job job;
+    while (jobs.pop(job)) {
+        uint64_t hash;
+        if (hash_file(job.path.c_str(), buf, hash)) {
+            results.push_back({job.size, hash, std::move(job.path)});
+        }
+    }
+}
+
+// Whether two files have the same bytes. A file that cannot be read matches
+// nothing.
+bool same_contents(const char* first, const char* second, char* first_buf, char* second_buf) {
+    int first_fd = open(first, O_RDONLY | O_CLOEXEC);
+    if (first_fd == -1) {
+        return false;
+    }
+    int second_fd = open(second, O_RDONLY | O_CLOEXEC);
+    if (second_fd == -1) {
+        close(first_fd);
+        return false;
+    }
+    posix_fadvise(first_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(second_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    bool same = true;
+    while (same) {
+        ssize_t first_got = read_full(first_fd, first_buf, kReadSize);
+        ssize_t second_got = read_full(second_fd, second_buf, kReadSize);
+        same = first_got != -1 && first_got == second_got &&
+               std::memcmp(first_buf, second_buf, first_got) == 0;
+        if (first_got <= 0) {
+            break;
+        }
+    }
+    close(first_fd);
+    close(second_fd);
+    return same;
+}
+
+// Splits files with equal size and hash into sets of identical contents, so
+// that a hash collision is never reported as a duplicate.
+void add_duplicates(size_t size, uint64_t hash, std::vector<std::string>& paths, char* first_buf,
+                    char* second_buf, std::vector<duplicate_set>& duplicates) {
+    std::vector<std::vector<std::string>> sets;
+    for (auto& path : paths) {
+        auto same = std::find_if(sets.begin(), sets.end(), [&](const std::vector<std::string>& set) {
+            return same_contents(set.front().c_str(), path.c_str(), first_buf, second_buf);
+        });
+        if (same != sets.end()) {
+            same->push_back(std::move(path));
+        } else {
+            sets.push_back({std::move(path)});
+        }
+    }
+    for (auto& set : sets) {
+        if (set.size() > 1) {
+            duplicates.push_back({size, hash, std::move(set)});
+        }
+    }
+}
+
+// Sums sizes into report and queues every file that shares its size with
+// another one; empty files only need collecting.
+void walk_tree(const char* path, disk_usage_report& report, bounded_queue<hash_job>& jobs,
+               std::vector<std::string>& empty_files) {
+    // Path of the first file seen with each size, emptied once it is queued.
+    std::unordered_map<size_t, std::string> first_of_size;
+    std::set<std::pair<dev_t, ino_t>> linked;
+
+    // Directories on the current branch with the bytes found under them so far.
+    std::vector<std::pair<std::string, size_t>> branch;
+    branch.emplace_back(path, 0);
+    auto close_dir = [&report, &branch]() {
+        auto [dir, size] = std::move(branch.back());
+        branch.pop_back();
+        branch.back().second += size;
+        report.directory_sizes[std::move(dir)] = size;
+    };
+
+    for (auto it = recursive_directory_iterator(path, directory_options::skip_permission_denied);
+         it != end(it); ++it) {
+        while (branch.size() > static_cast<size_t>(it.depth()) + 1) {
+            close_dir();
+        }
+
+        if (it->is_directory()) {
+            ++report.directories;
+            branch.emplace_back(it->path(), 0);
+            continue;
+        }
+        if (!it->is_regular_file()) {
+            continue;
+        }
+
+        it->prefetch(STATX_SIZE | STATX_NLINK | STATX_INO);
+        if (it->hard_link_count() > 1 && !linked.emplace(it->device(), it->inode()).second) {
+            continue;
+        }
+
+        size_t size = it->file_size();
+        ++report.files;
+        report.total_size += size;
+        branch.back().second += size;
+
+        if (size == 0) {
+            empty_files.emplace_back(it->path());
+            continue;
+        }
+        auto [first, inserted] = first_of_size.try_emplace(size, it->path());
+        if (inserted) {
+            continue;
+        }
+        if (!first->second.empty()) {
+            jobs.push({size, std::move(first->second)});
+            first->second.clear();
+        }
+        jobs.push({size, it->path()});
+    }
+
+    while (branch.size() > 1) {
+        close_dir();
+    }
+    report.directory_sizes[path] = branch.back().second;
+}
+
+}  // namespace
+
+xxhash64::xxhash64(uint64_t seed)
+    : seed_(seed), acc_{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1} {}
+
+void xxhash64::update(const void* data, size_t len) {
+    auto ptr = static_cast<const unsigned char*>(data);
+    const unsigned char* end = ptr + len;
+    total_ += len;
+
+    if (tail_len_ + len < 32) {
+        std::memcpy(tail_ + tail_len_, ptr, len);
+        tail_len_ += len;
+        return;
+    }
+
+    if (tail_len_ != 0) {
+        size_t fill = 32 - tail_len_;
+        std::memcpy(tail_ + tail_len_, ptr, fill);
+        for (int i = 0; i < 4; ++i) {
+            acc_[i] = round(acc_[i], read64(tail_ + 8 * i));
+        }
+        ptr += fill;
+        tail_len_ = 0;
+    }
+
+    for (; ptr + 32 <= end; ptr += 32) {
+        for (int i = 0; i < 4; ++i) {
+            acc_[i] = round(acc_[i], read64(ptr + 8 * i));
+        }
+    }
+
+    tail_len_ = end - ptr;
+    std::memcpy(tail_, ptr, tail_len_);
+}
+
+uint64_t xxhash64::digest() const {
+    uint64_t hash;
+    if (total_ >= 32) {
+        hash = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+        for (int i = 0; i < 4; ++i) {
+            hash = merge_round(hash, acc_[i]);
+        }
+    } else {
+        hash = seed_ + kPrime5;
+    }
+    hash += total_;
+
+    const unsigned char* ptr = tail_;
+    const unsigned char* end = tail_ + tail_len_;
+    for (; ptr + 8 <= end; ptr += 8) {
+        hash ^= round(0, read64(ptr));
+        hash = rotl(hash, 27) * kPrime1 + kPrime4;
+    }
+    if (ptr + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(ptr)) * kPrime1;
+        hash = rotl(hash, 23) * kPrime2 + kPrime3;
+        ptr += 4;
+    }
+    for (; ptr < end; ++ptr) {
+        hash ^= *ptr * kPrime5;
+        hash = rotl(hash, 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+disk_usage_report scan_disk_usage(const char* path, size_t threads, size_t queue_capacity) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    disk_usage_report report;
+    bounded_queue<hash_job> jobs(queue_capacity);
+    std::vector<std::vector<hash_result>> results(threads);
+    std::vector<std::string> empty_files;
+    std::vector<read_buffer> buffers;
+    std::vector<std::thread> workers;
+    auto stop_workers = [&jobs, &workers]() {
+        jobs.close();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    try {
+        for (size_t i = 0; i < std::max<size_t>(threads, 2); ++i) {
+            buffers.push_back(make_read_buffer());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back(hash_worker, std::ref(jobs), std::ref(results[i]), buffers[i].get());
+        }
+        walk_tree(path, report, jobs, empty_files);
+    } catch (...) {
+        stop_workers();
+        throw;
+    }
+    stop_workers();
+
+    std::map<std::pair<size_t, uint64_t>, std::vector<std::string>> groups;
+    for (auto& worker_results : results) {
+        for (auto& res : worker_results) {
+            groups[{res.size, res.hash}].push_back(std::move(res.path));
+        }
+    }
+
+    if (empty_files.size() > 1) {
+        report.duplicates.push_back({0, xxhash64().digest(), std::move(empty_files)});
+    }
+    for (auto& [key, paths] : groups) {
+        if (paths.size() > 1) {
+            add_duplicates(key.first, key.second, paths, buffers[0].get(), buffers[1].get(),
+                           report.duplicates);
+        }
+    }
+    return report;
+}
+
+}  // namespace stdlike
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rec_dir_it.hpp"
+
+namespace stdlike {
+
+// Streaming XXH64, the 64-bit xxHash by Yann Collet.
+class xxhash64 {
+ public:
+  explicit xxhash64(uint64_t seed = 0);
+
+  void update(const void* data, size_t len);
+
+  uint64_t digest() const;
+
+ private:
+  uint64_t seed_;
+  uint64_t acc_[4];
+  uint64_t total_ = 0;
+  unsigned char tail_[32];
+  size_t tail_len_ = 0;
+};
+
+struct duplicate_set {
+  size_t size = 0;
+  uint64_t hash = 0;
+  std::vector<std::string> paths;
+};
+
+struct disk_usage_report {
+  size_t files = 0;
+  size_t directories = 0;
+  size_t total_size = 0;
+  // Bytes in regular files under every directory, subdirectories included.
+  std::unordered_map<std::string, size_t> directory_sizes;
+  std::vector<duplicate_set> duplicates;
+};
+
+// The calling thread walks the tree and pushes files into a bounded queue,
+// threads workers hash them. A file is only read once another file of the
+// same size has been seen, so files with a unique size are never opened.
+// Files with equal size and hash are compared byte by byte before they are
+// reported as duplicates. Like du, a file with several hard links is counted
+// once, under the first path seen, and its links are not reported as
+// duplicates of each other. Directories that cannot be read for lack of
+// permission are skipped; other errors throw.
+disk_usage_report scan_disk_usage(const char* path, size_t threads = 0,
+                                  size_t queue_capacity = 1024);
+
+}  // namespace stdlike
\ No newline at end of file
@@ -1,83 +1,513 @@
 #include "rec_dir_it.hpp"
-#include <filesystem>
-#include <fstream>
-#include <iostream>
+#include <fnmatch.h>
+#include <sys/syscall.h>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
 #include <vector>
 
 namespace stdlike {
 
-directory_entry::directory_entry(const std::string& path) : path_(path) {
-    lstat(path_.c_str(), &stat_);
+namespace detail {
+
+enum class traversal_counter {
+    entries = 0,
+    getdents = 1,
+    open = 2,
+    stat = 3
+};
+
+#ifdef STDLIKE_TRAVERSAL_STATS
+std::atomic<size_t> traversal_counters[4];
+#endif
+
+inline void count(traversal_counter counter) {
+#ifdef STDLIKE_TRAVERSAL_STATS
+    traversal_counters[static_cast<int>(counter)].fetch_add(1, std::memory_order_relaxed);
+#else
+    static_cast<void>(counter);
+#endif
 }
 
-recursive_directory_iterator::recursive_directory_iterator(const char* path,
-                                                           directory_options dir_opt)
-    : dir_opt_(dir_opt), dirs_path_(new std::stack<DIR*>()), cur_path_(path) {
-    DIR* dir = opendir(path);
-    dirs_path_->emplace(dir);
-    this->operator++();
+// Reads a directory in large getdents64 batches. The buffer is allocated on
+// first use and reused for every directory opened through the same reader.
+class dir_reader {
+ public:
+    dir_reader() = default;
+
+    dir_reader(dir_reader&& other) noexcept
+        : fd_(other.fd_), buf_(std::move(other.buf_)), pos_(other.pos_), len_(other.len_) {
+        other.fd_ = -1;
+    }
+
+    ~dir_reader() { close(); }
+
+    bool open(int parent_fd, const char* name, bool follow) {
+        close();
+        count(traversal_counter::open);
+        fd_ = openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | (follow ? 0 : O_NOFOLLOW));
+        pos_ = len_ = 0;
+        return fd_ != -1;
+    }
+
+    void close() {
+        if (fd_ != -1) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd() const { return fd_; }
+
+    const dirent64* next() {
+        if (pos_ == len_) {
+            if (buf_ == nullptr) {
+                buf_.reset(new char[kBufSize]);
+            }
+            count(traversal_counter::getdents);
+            long got = syscall(SYS_getdents64, fd_, buf_.get(), kBufSize);
+            if (got <= 0) {
+                return nullptr;
+            }
+            len_ = got;
+            pos_ = 0;
+        }
+        auto entry = reinterpret_cast<const dirent64*>(buf_.get() + pos_);
+        pos_ += entry->d_reclen;
+        return entry;
+    }
+
+ private:
+    static const size_t kBufSize = 32 * 1024;
+
+    int fd_ = -1;
+    std::unique_ptr<char[]> buf_;
+    size_t pos_ = 0;
+    size_t len_ = 0;
+};
+
+// Called after a directory failed to open. Like std::filesystem, the walk
+// throws, unless the directory is unreadable and skip_permission_denied is set.
+void handle_open_error(directory_options dir_opt, const std::string& dir_path, const char* name) {
+    int error = errno;
+    if (error == EACCES && has_option(dir_opt, directory_options::skip_permission_denied)) {
+        return;
+    }
+    std::string path = (name == nullptr) ? dir_path : dir_path + '/' + name;
+    throw std::system_error(error, std::generic_category(), "cannot open directory " + path);
 }
 
-recursive_directory_iterator& recursive_directory_iterator::operator++() {
-    if (dirs_path_->empty()) {
-        *this = end(*this);
+// Set of (device, inode) pairs with open addressing and linear probing. Slots
+// are two words wide, a zero inode marks an empty slot.
+class inode_set {
+ public:
+    bool insert(dev_t dev, ino_t ino) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        if (!place(slots_, dev, ino)) {
+            return false;
+        }
+        ++size_;
+        return true;
+    }
+
+ private:
+    struct slot {
+        uint64_t dev = 0;
+        uint64_t ino = 0;
+    };
+
+    static size_t hash(uint64_t dev, uint64_t ino) {
+        uint64_t x = ino ^ (dev * 0x9e3779b97f4a7c15ULL);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    static bool place(std::vector<slot>& slots, uint64_t dev, uint64_t ino) {
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(dev, ino) & mask;; i = (i + 1) & mask) {
+            if (slots[i].ino == 0) {
+                slots[i] = {dev, ino};
+                return true;
+            }
+            if (slots[i].ino == ino && slots[i].dev == dev) {
+                return false;
+            }
+        }
+    }
+
+    void grow() {
+        std::vector<slot> slots(slots_.empty() ? 64 : slots_.size() * 2);
+        for (const auto& cur : slots_) {
+            if (cur.ino != 0) {
+                place(slots, cur.dev, cur.ino);
+            }
+        }
+        slots_ = std::move(slots);
+    }
+
+    std::vector<slot> slots_;
+    size_t size_ = 0;
+};
+
+// Decides whether a freshly opened directory is walked. With same_filesystem
+// it has to live on root_dev, when links are followed it must not have been
+// walked before, which also breaks symlink cycles.
+bool admit_directory(int fd, directory_options dir_opt, dev_t& root_dev, inode_set& visited,
+                     bool is_root) {
+    bool follow = has_option(dir_opt, directory_options::follow_directory_symlink);
+    bool same_fs = has_option(dir_opt, directory_options::same_filesystem);
+    if (!follow && !same_fs) {
+        return true;
+    }
+
+    struct stat stat_for_dir;
+    count(traversal_counter::stat);
+    if (fstat(fd, &stat_for_dir) != 0) {
+        return false;
+    }
+    if (is_root) {
+        root_dev = stat_for_dir.st_dev;
+    } else if (same_fs && stat_for_dir.st_dev != root_dev) {
+        return false;
+    }
+    return !follow || visited.insert(stat_for_dir.st_dev, stat_for_dir.st_ino);
+}
+
+}  // namespace detail
+
+directory_entry::directory_entry(const std::string& path) : path_(path) {}
+
+directory_entry::directory_entry(const std::string* dir_path, const char* name, int dir_fd,
+                                 unsigned char d_type)
+    : type_(d_type == DT_UNKNOWN ? 0 : DTTOIF(d_type)),
+      dir_fd_(dir_fd),
+      dir_path_(dir_path),
+      name_(name) {}
+
+directory_entry::directory_entry(const directory_entry& other)
+    : stat_(other.stat_),
+      stat_mask_(other.stat_mask_),
+      type_(other.type_),
+      path_(other.path()) {}
+
+directory_entry& directory_entry::operator=(const directory_entry& other) {
+    if (&other == this) {
         return *this;
     }
+    stat_ = other.stat_;
+    stat_mask_ = other.stat_mask_;
+    type_ = other.type_;
+    dir_fd_ = AT_FDCWD;
+    path_ = other.path();
+    dir_path_ = nullptr;
+    name_ = nullptr;
+    return *this;
+}
 
-    if (!entry_.path_.empty()) {
+directory_entry::directory_entry(directory_entry&& other)
+    : stat_(other.stat_),
+      stat_mask_(other.stat_mask_),
+      type_(other.type_) {
+    other.path();
+    path_ = std::move(other.path_);
+}
 
-        struct stat stat_for_dir;
-        stat(entry_.path(), &stat_for_dir);
-        bool is_dir = S_ISDIR(stat_for_dir.st_mode);
+directory_entry& directory_entry::operator=(directory_entry&& other) {
+    if (&other == this) {
+        return *this;
+    }
+    other.path();
+    stat_ = other.stat_;
+    stat_mask_ = other.stat_mask_;
+    type_ = other.type_;
+    dir_fd_ = AT_FDCWD;
+    path_ = std::move(other.path_);
+    dir_path_ = nullptr;
+    name_ = nullptr;
+    return *this;
+}
+
+void directory_entry::assign(const std::string* dir_path, const char* name, int dir_fd,
+                             unsigned char d_type) {
+    stat_mask_ = 0;
+    type_ = (d_type == DT_UNKNOWN) ? 0 : DTTOIF(d_type);
+    dir_fd_ = dir_fd;
+    dir_path_ = dir_path;
+    name_ = name;
+}
+
+const char* directory_entry::path() const {
+    if (dir_path_ != nullptr) {
+        path_.reserve(dir_path_->size() + strlen(name_) + 1);
+        path_.assign(*dir_path_);
+        path_ += '/';
+        path_ += name_;
+        dir_path_ = nullptr;
+    }
+    return path_.c_str();
+}
+
+const char* directory_entry::filename() const {
+    if (dir_path_ != nullptr) {
+        return name_;
+    }
+    size_t last_slash = path_.rfind('/');
+    return path_.c_str() + (last_slash == std::string::npos ? 0 : last_slash + 1);
+}
+
+mode_t directory_entry::type() const {
+    if (type_ == 0) {
+        type_ = fetch(STATX_TYPE).stx_mode & S_IFMT;
+    }
+    return type_;
+}
 
-        if (is_dir) {
-            bool is_denied = (access(entry_.path(), R_OK) != 0);
-            if (!(entry_.is_symlink() && dir_opt_ != directory_options::follow_directory_symlink) &&
-                !(is_denied && dir_opt_ == directory_options::skip_permission_denied)) {
-                DIR* dir = opendir(entry_.path());
-                dirs_path_->emplace(dir);
-                cur_path_ = entry_.path_;
+const struct statx& directory_entry::fetch(unsigned int mask) const {
+    if ((stat_mask_ & mask) == mask) {
+        return stat_;
+    }
+
+    mask |= stat_mask_;
+    const char* target = (dir_fd_ == AT_FDCWD) ? path() : filename();
+    detail::count(detail::traversal_counter::stat);
+    if (statx(dir_fd_, target, AT_SYMLINK_NOFOLLOW, mask, &stat_) != 0) {
+        stat_ = {};
+    }
+    stat_mask_ |= mask;
+    return stat_;
+}
+
+void directory_entry::refresh() {
+    unsigned int mask = stat_mask_ | STATX_TYPE;
+    stat_mask_ = 0;
+    type_ = fetch(mask).stx_mode & S_IFMT;
+}
+
+bool directory_filter::excludes(const std::string& dir_path, const char* name) const {
+    for (const auto& glob : exclude_globs) {
+        if (fnmatch(glob.c_str(), name, 0) == 0) {
+            return true;
+        }
+    }
+
+    size_t name_len = strlen(name);
+    for (const auto& path : exclude_paths) {
+        if (path.size() == dir_path.size() + 1 + name_len &&
+            path.compare(0, dir_path.size(), dir_path) == 0 && path[dir_path.size()] == '/' &&
+            path.compare(dir_path.size() + 1, name_len, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool directory_filter::matches(const directory_entry& entry) const {
+    const char* name = entry.filename();
+
+    if (!name_globs.empty()) {
+        bool found = false;
+        for (const auto& glob : name_globs) {
+            if (fnmatch(glob.c_str(), name, 0) == 0) {
+                found = true;
+                break;
             }
         }
+        if (!found) {
+            return false;
+        }
     }
 
-    auto next_file = readdir(dirs_path_->top());
+    if (!extensions.empty()) {
+        size_t name_len = strlen(name);
+        bool found = false;
+        for (const auto& ext : extensions) {
+            if (ext.size() <= name_len && ext.compare(0, ext.size(), name + name_len - ext.size()) == 0) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
 
-    while (next_file == nullptr || next_file->d_name[0] == '.') {
-        if (next_file == nullptr) {
-            pop();
+    if (name_regex && !std::regex_search(name, *name_regex)) {
+        return false;
+    }
+
+    if (min_size != 0 || max_size != std::numeric_limits<size_t>::max()) {
+        size_t size = entry.file_size();
+        if (size < min_size || size > max_size) {
+            return false;
         }
-        if (dirs_path_->empty()) {
-            *this = end(*this);
-            return *this;
+    }
+
+    if (min_write_time != std::numeric_limits<time_t>::min() ||
+        max_write_time != std::numeric_limits<time_t>::max()) {
+        time_t write_time = entry.last_write_time();
+        if (write_time < min_write_time || write_time > max_write_time) {
+            return false;
         }
-        next_file = readdir(dirs_path_->top());
     }
 
-    entry_ = directory_entry(cur_path_ + '/' + static_cast<std::string>(next_file->d_name));
+    return !predicate || predicate(entry);
+}
+
+struct recursive_directory_iterator::walk_state {
+    std::vector<detail::dir_reader> readers;
+    std::vector<size_t> path_lens;
+    size_t depth = 0;
+    std::string dir_path;
+    std::optional<directory_filter> filter;
+    detail::inode_set visited;
+    dev_t root_dev = 0;
+
+    detail::dir_reader& top() { return readers[depth - 1]; }
+};
+
+recursive_directory_iterator::recursive_directory_iterator(const char* path,
+                                                           directory_options dir_opt)
+    : dir_opt_(dir_opt), state_(std::make_shared<walk_state>()) {
+    open(path);
+}
+
+recursive_directory_iterator::recursive_directory_iterator(const char* path,
+                                                           directory_options dir_opt,
+                                                           directory_filter filter)
+    : dir_opt_(dir_opt), state_(std::make_shared<walk_state>()) {
+    state_->filter = std::move(filter);
+    open(path);
+}
+
+recursive_directory_iterator& recursive_directory_iterator::operator++() {
+    if (state_ == nullptr) {
+        return *this;
+    }
+
+    descend();
+    next();
     return *this;
 }
 
-void recursive_directory_iterator::pop() {
-    int last_slash = cur_path_.length() - 1;
-    for (; last_slash >= 0; --last_slash) {
-        if (cur_path_[last_slash] == '/') {
-            break;
-        }
+void recursive_directory_iterator::open(const char* path) {
+    state_->dir_path = path;
+    state_->readers.emplace_back();
+    if (!state_->readers[0].open(AT_FDCWD, path, true)) {
+        detail::handle_open_error(dir_opt_, state_->dir_path, nullptr);
+        state_.reset();
+        return;
+    }
+    if (!detail::admit_directory(state_->readers[0].fd(), dir_opt_, state_->root_dev,
+                                 state_->visited, true)) {
+        state_.reset();
+        return;
     }
-    cur_path_ = cur_path_.substr(0, last_slash);
-    closedir(dirs_path_->top());
-    dirs_path_->pop();
-    entry_ = directory_entry(cur_path_);
+    state_->depth = 1;
+    next();
 }
 
-recursive_directory_iterator::~recursive_directory_iterator() {
-    if (dirs_path_.use_count() != 1) {
+void recursive_directory_iterator::descend() {
+    const auto& filter = state_->filter;
+    if (filter && filter->max_depth >= 0 && depth() >= filter->max_depth) {
         return;
     }
-    while (!dirs_path_->empty()) {
-        closedir(dirs_path_->top());
-        dirs_path_->pop();
+
+    bool is_dir = entry_.is_directory();
+    if (entry_.is_symlink() && has_option(dir_opt_, directory_options::follow_directory_symlink)) {
+        struct stat stat_for_dir;
+        detail::count(detail::traversal_counter::stat);
+        is_dir = (fstatat(state_->top().fd(), entry_.filename(), &stat_for_dir, 0) == 0 &&
+                  S_ISDIR(stat_for_dir.st_mode));
+    }
+    if (is_dir) {
+        push(entry_.filename());
+    }
+}
+
+int recursive_directory_iterator::depth() const {
+    return static_cast<int>(state_->depth) - 1;
+}
+
+void recursive_directory_iterator::pop() {
+    pop_frame();
+    if (state_->depth == 0) {
+        *this = end(*this);
+        return;
+    }
+    next();
+}
+
+bool recursive_directory_iterator::push(const char* name) {
+    walk_state& state = *state_;
+    if (state.depth == state.readers.size()) {
+        state.readers.emplace_back();
+    }
+
+    detail::dir_reader& reader = state.readers[state.depth];
+    bool follow = has_option(dir_opt_, directory_options::follow_directory_symlink);
+    if (!reader.open(state.top().fd(), name, follow)) {
+        detail::handle_open_error(dir_opt_, state.dir_path, name);
+        return false;
+    }
+    if (!detail::admit_directory(reader.fd(), dir_opt_, state.root_dev, state.visited, false)) {
+        reader.close();
+        return false;
+    }
+
+    state.path_lens.push_back(state.dir_path.size());
+    state.dir_path += '/';
+    state.dir_path += name;
+    ++state.depth;
+    return true;
+}
+
+void recursive_directory_iterator::pop_frame() {
+    walk_state& state = *state_;
+    state.top().close();
+    --state.depth;
+    if (!state.path_lens.empty()) {
+        state.dir_path.resize(state.path_lens.back());
+        state.path_lens.pop_back();
+    }
+}
+
+void recursive_directory_iterator::next() {
+    while (true) {
+        const dirent64* next_file = state_->top().next();
+        if (next_file == nullptr) {
+            pop_frame();
+            if (state_->depth == 0) {
+                *this = end(*this);
+                return;
+            }
+            continue;
+        }
+        if (next_file->d_name[0] == '.') {
+            continue;
+        }
+
+        const auto& filter = state_->filter;
+        if (filter && filter->excludes(state_->dir_path, next_file->d_name)) {
+            continue;
+        }
+
+        entry_.assign(&state_->dir_path, next_file->d_name, state_->top().fd(), next_file->d_type);
+        if (filter && !filter->matches(entry_)) {
+            descend();
+            continue;
+        }
+        detail::count(detail::traversal_counter::entries);
+        return;
     }
 }
 
@@ -88,4 +518,205 @@ recursive_directory_iterator end(recursive_directory_iterator) noexcept {
     return {};
 }
 
+namespace detail {
+
+struct walk_queue {
+    std::mutex mutex;
+    std::deque<std::string> dirs;
+};
+
+class parallel_walker {
+ public:
+    parallel_walker(const std::function<void(const directory_entry&)>& callback,
+                    directory_options dir_opt, size_t threads)
+        : callback_(callback), dir_opt_(dir_opt), queues_(threads), readers_(threads) {}
+
+    void run(const char* path) {
+        root_ = path;
+        push(0, path);
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+ private:
+    // queued_ is raised before the directory is published, so a thief that
+    // takes it at once cannot drive the count below zero.
+    void push(size_t id, std::string path) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        queued_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(queues_[id].mutex);
+            queues_[id].dirs.emplace_back(std::move(path));
+        }
+        if (sleepers_.load() != 0) {
+            wake(false);
+        }
+    }
+
+    // Taking idle_mutex_ before notifying closes the gap between a sleeper's
+    // last look at the counters and its wait.
+    void wake(bool all) {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+        }
+        if (all) {
+            idle_.notify_all();
+        } else {
+            idle_.notify_one();
+        }
+    }
+
+    // Parks an idle worker until a directory is queued or the walk is over.
+    void sleep() {
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        sleepers_.fetch_add(1);
+        idle_.wait(lock, [this] { return queued_.load() != 0 || pending_.load() == 0; });
+        sleepers_.fetch_sub(1);
+    }
+
+    bool take(size_t id, std::string& path) {
+        {
+            std::lock_guard<std::mutex> lock(queues_[id].mutex);
+            if (!queues_[id].dirs.empty()) {
+                path = std::move(queues_[id].dirs.back());
+                queues_[id].dirs.pop_back();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (size_t step = 1; step < queues_.size(); ++step) {
+            walk_queue& victim = queues_[(id + step) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.dirs.empty()) {
+                path = std::move(victim.dirs.front());
+                victim.dirs.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t id) {
+        std::string path;
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            if (!take(id, path)) {
+                sleep();
+                continue;
+            }
+            if (!stopped_.load(std::memory_order_relaxed)) {
+                try {
+                    scan(id, path);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex_);
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                    stopped_.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                wake(true);
+            }
+        }
+    }
+
+    void scan(size_t id, const std::string& dir_path) {
+        dir_reader& reader = readers_[id];
+        if (!reader.open(AT_FDCWD, dir_path.c_str(), true)) {
+            handle_open_error(dir_opt_, dir_path, nullptr);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(visited_mutex_);
+            if (!admit_directory(reader.fd(), dir_opt_, root_dev_, visited_, dir_path == root_)) {
+                reader.close();
+                return;
+            }
+        }
+
+        for (auto next_file = reader.next(); next_file != nullptr; next_file = reader.next()) {
+            if (next_file->d_name[0] == '.') {
+                continue;
+            }
+
+            directory_entry entry(&dir_path, next_file->d_name, reader.fd(), next_file->d_type);
+            count(traversal_counter::entries);
+            callback_(entry);
+
+            bool is_dir = entry.is_directory();
+            if (entry.is_symlink() && has_option(dir_opt_, directory_options::follow_directory_symlink)) {
+                struct stat stat_for_dir;
+                count(traversal_counter::stat);
+                is_dir = (fstatat(reader.fd(), next_file->d_name, &stat_for_dir, 0) == 0 &&
+                          S_ISDIR(stat_for_dir.st_mode));
+            }
+            if (is_dir) {
+                push(id, dir_path + '/' + next_file->d_name);
+            }
+        }
+        reader.close();
+    }
+
+    const std::function<void(const directory_entry&)>& callback_;
+    directory_options dir_opt_;
+    std::vector<walk_queue> queues_;
+    std::vector<dir_reader> readers_;
+    std::string root_;
+    std::mutex visited_mutex_;
+    inode_set visited_;
+    dev_t root_dev_ = 0;
+    std::atomic<size_t> pending_ = 0;
+    std::atomic<size_t> queued_ = 0;
+    std::atomic<size_t> sleepers_ = 0;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;
+    std::atomic<bool> stopped_ = false;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+}  // namespace detail
+
+void parallel_walk(const char* path,
+                   const std::function<void(const directory_entry&)>& callback,
+                   directory_options dir_opt, size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    detail::parallel_walker(callback, dir_opt, threads).run(path);
+}
+
+traversal_stats get_traversal_stats() {
+    traversal_stats stats;
+#ifdef STDLIKE_TRAVERSAL_STATS
+    using detail::traversal_counter;
+    using detail::traversal_counters;
+    stats.entries = traversal_counters[static_cast<int>(traversal_counter::entries)].load();
+    stats.getdents_calls = traversal_counters[static_cast<int>(traversal_counter::getdents)].load();
+    stats.open_calls = traversal_counters[static_cast<int>(traversal_counter::open)].load();
+    stats.stat_calls = traversal_counters[static_cast<int>(traversal_counter::stat)].load();
+#endif
+    return stats;
+}
+
+void reset_traversal_stats() {
+#ifdef STDLIKE_TRAVERSAL_STATS
+    for (auto& counter : detail::traversal_counters) {
+        counter.store(0);
+    }
+#endif
+}
+
 }  // namespace stdlike
\ No newline at end of file
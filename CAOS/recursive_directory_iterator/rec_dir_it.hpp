@@ -1,21 +1,44 @@
 #pragma once
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include <time.h>
+#include <functional>
+#include <limits>
 #include <memory>
-#include <stack>
+#include <optional>
+#include <regex>
 #include <string>
 #include <unistd.h>
+#include <vector>
 
 namespace stdlike {
 
 enum class directory_options {
-  none = 1,
-  follow_directory_symlink = 2,
-  skip_permission_denied = 3
+  none = 0,
+  follow_directory_symlink = 1,
+  skip_permission_denied = 2,
+  same_filesystem = 4
 };
 
+inline directory_options operator|(directory_options first, directory_options second) {
+  return static_cast<directory_options>(static_cast<int>(first) | static_cast<int>(second));
+}
+
+inline directory_options operator&(directory_options first, directory_options second) {
+  return static_cast<directory_options>(static_cast<int>(first) & static_cast<int>(second));
+}
+
+inline bool has_option(directory_options options, directory_options option) {
+  return (options & option) != directory_options::none;
+}
+
+namespace detail {
+class parallel_walker;
+}  // namespace detail
+
 class directory_entry {
  public:
 
@@ -23,40 +46,108 @@ class directory_entry {
 
   directory_entry(const std::string& path);
 
-  bool operator==(const directory_entry& other) { return this->path_ == other.path_; }
+  directory_entry(const directory_entry& other);
+
+  // Copies and moves build the full path and detach from the walker, so they
+  // stay valid after it advances.
+  directory_entry(directory_entry&& other);
+
+  directory_entry& operator=(const directory_entry& other);
+
+  directory_entry& operator=(directory_entry&& other);
+
+  bool operator==(const directory_entry& other) { return std::string(path()) == other.path(); }
+
+  // Entries produced by a walk keep only their name and a reference to the
+  // walker's current directory, the full path is built on the first call.
+  const char* path() const;
 
-  const char* path() const { return path_.c_str(); }
+  const char* filename() const;
 
-  bool is_directory() const { return S_ISDIR(stat_.st_mode); }
+  // File type comes from d_type when the walk provides it. Everything else is
+  // fetched with statx on first access, asking only for the needed fields.
+  bool is_directory() const { return S_ISDIR(type()); }
 
-  bool is_symlink() const { return S_ISLNK(stat_.st_mode); }
+  bool is_symlink() const { return S_ISLNK(type()); }
 
-  bool is_regular_file() const { return S_ISREG(stat_.st_mode); }
+  bool is_regular_file() const { return S_ISREG(type()); }
 
-  bool is_block_file() const { return S_ISBLK(stat_.st_mode); }
+  bool is_block_file() const { return S_ISBLK(type()); }
 
-  bool is_character_file() const { return S_ISCHR(stat_.st_mode); }
+  bool is_character_file() const { return S_ISCHR(type()); }
 
-  bool is_socket() const { return S_ISSOCK(stat_.st_mode); }
+  bool is_socket() const { return S_ISSOCK(type()); }
 
-  bool is_fifo() const { return S_ISFIFO(stat_.st_mode); }
+  bool is_fifo() const { return S_ISFIFO(type()); }
 
-  size_t file_size() const { return stat_.st_size; }
+  size_t file_size() const { return fetch(STATX_SIZE).stx_size; }
 
-  size_t hard_link_count() const { return stat_.st_nlink; }
+  size_t hard_link_count() const { return fetch(STATX_NLINK).stx_nlink; }
+
+  ino_t inode() const { return fetch(STATX_INO).stx_ino; }
+
+  dev_t device() const {
+    const struct statx& stat = fetch(STATX_INO);
+    return makedev(stat.stx_dev_major, stat.stx_dev_minor);
+  }
 
   auto last_write_time() const {
-    return stat_.st_ctime;
+    return static_cast<time_t>(fetch(STATX_CTIME).stx_ctime.tv_sec);
   }
 
-  auto permitions() { return stat_.st_mode; }
+  auto permitions() { return fetch(STATX_TYPE | STATX_MODE).stx_mode; }
+
+  // Drops the cached attributes and fetches the same set again.
+  void refresh();
+
+  // Fetches the given STATX_* fields with one call, for callers about to read
+  // several attributes that would otherwise cost a statx each.
+  void prefetch(unsigned int mask) const { fetch(mask); }
 
  private:
 
-  struct stat stat_;
-  std::string path_;
+  directory_entry(const std::string* dir_path, const char* name, int dir_fd, unsigned char d_type);
+
+  // Turns this entry into the walker's next one, keeping the path buffer.
+  void assign(const std::string* dir_path, const char* name, int dir_fd, unsigned char d_type);
+
+  mode_t type() const;
+
+  const struct statx& fetch(unsigned int mask) const;
+
+  mutable struct statx stat_ = {};
+  mutable unsigned int stat_mask_ = 0;
+  mutable mode_t type_ = 0;
+  int dir_fd_ = AT_FDCWD;
+  mutable std::string path_;
+  mutable const std::string* dir_path_ = nullptr;
+  const char* name_ = nullptr;
 
   friend class recursive_directory_iterator;
+  friend class detail::parallel_walker;
+};
+
+// Conditions checked by the walker itself. Exclusions and max_depth prune:
+// an excluded or too deep directory is never opened. The other fields select
+// which entries are yielded, like the tests of find(1): a directory that does
+// not match is still descended. Name tests run on the raw directory record,
+// size and time tests stat only when they are set.
+struct directory_filter {
+  std::vector<std::string> name_globs;
+  std::vector<std::string> extensions;
+  std::optional<std::regex> name_regex;
+  std::vector<std::string> exclude_globs;
+  std::vector<std::string> exclude_paths;
+  int max_depth = -1;
+  size_t min_size = 0;
+  size_t max_size = std::numeric_limits<size_t>::max();
+  time_t min_write_time = std::numeric_limits<time_t>::min();
+  time_t max_write_time = std::numeric_limits<time_t>::max();
+  std::function<bool(const directory_entry&)> predicate;
+
+  bool excludes(const std::string& dir_path, const char* name) const;
+
+  bool matches(const directory_entry& entry) const;
 };
 
 class recursive_directory_iterator {
@@ -66,30 +157,66 @@ class recursive_directory_iterator {
 
   recursive_directory_iterator(const char* path, directory_options dir_opt = directory_options::none);
 
+  recursive_directory_iterator(const char* path, directory_options dir_opt, directory_filter filter);
+
   const directory_entry& operator*() { return entry_; }
 
   const directory_entry* operator->() { return &entry_; }
 
   recursive_directory_iterator& operator++();
 
-  bool operator==(const recursive_directory_iterator& other) {return (this->entry_ == other.entry_); }
+  bool operator==(const recursive_directory_iterator& other) {
+    return state_ == other.state_;
+  }
 
   bool operator!=(const recursive_directory_iterator& other) {return !(*this == other); };
 
-  int depth() { return static_cast<int>(dirs_path_->size()) - 1; }
+  int depth() const;
 
   void pop();
 
-  ~recursive_directory_iterator();
-
  private:
+  struct walk_state;
+
+  void open(const char* path);
+
+  void descend();
+
+  bool push(const char* name);
+
+  void pop_frame();
+
+  void next();
+
   directory_entry entry_;
   directory_options dir_opt_;
-  std::shared_ptr<std::stack<DIR*>> dirs_path_;
-  std::string cur_path_;
+  std::shared_ptr<walk_state> state_;
 };
 
 recursive_directory_iterator begin( recursive_directory_iterator iter );
 recursive_directory_iterator end( recursive_directory_iterator ) noexcept;
 
+// Walks the tree under path on a pool of threads. Every worker owns a deque of
+// pending directories and takes work from its back, idle workers steal from the
+// front of the others and sleep while every deque is empty. The callback is
+// invoked concurrently from the workers, in no particular order. threads == 0
+// means hardware_concurrency().
+void parallel_walk(const char* path,
+                   const std::function<void(const directory_entry&)>& callback,
+                   directory_options dir_opt = directory_options::none,
+                   size_t threads = 0);
+
+// Process-wide counters of the syscalls made by the traversal code. They are
+// compiled in only with -DSTDLIKE_TRAVERSAL_STATS, otherwise they stay zero.
+struct traversal_stats {
+  size_t entries = 0;
+  size_t getdents_calls = 0;
+  size_t open_calls = 0;
+  size_t stat_calls = 0;
+};
+
+traversal_stats get_traversal_stats();
+
+void reset_traversal_stats();
+
 }  // namespace stdlike
\ No newline at end of file